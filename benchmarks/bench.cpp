@@ -1,39 +1,55 @@
 #include <benchmark/benchmark.h>
 
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "order_book.h"
+#include "order_parser.h"
+#include "parallel_reader.h"
+#include "prefix_sum.h"
 #include "spdlog/spdlog.h"
 
+template <typename Backend>
 static void BM_Bid(benchmark::State& state) {
     spdlog::set_level(spdlog::level::critical);
-    ob::OrderBook order_book;
+    ob::OrderBook<Backend> order_book;
     ob::Order order_buy{1, ob::OrderSide::BUY, 10, 5};
 
     for (auto _ : state) {
+        // Order IDs must be unique, otherwise the book rejects the order
+        ++order_buy.id;
         order_book.bid(order_buy);
     }
 }
-BENCHMARK(BM_Bid);
+BENCHMARK_TEMPLATE(BM_Bid, ob::MapBackend);
+BENCHMARK_TEMPLATE(BM_Bid, ob::FlatBackend);
 
+template <typename Backend>
 static void BM_Ask(benchmark::State& state) {
     spdlog::set_level(spdlog::level::critical);
-    ob::OrderBook order_book;
+    ob::OrderBook<Backend> order_book;
     ob::Order order_sell{1, ob::OrderSide::SELL, 10, 5};
 
     for (auto _ : state) {
+        // Order IDs must be unique, otherwise the book rejects the order
+        ++order_sell.id;
         order_book.ask(order_sell);
     }
 }
-BENCHMARK(BM_Ask);
+BENCHMARK_TEMPLATE(BM_Ask, ob::MapBackend);
+BENCHMARK_TEMPLATE(BM_Ask, ob::FlatBackend);
 
+template <typename Backend>
 static void BM_Ask_Exec(benchmark::State& state) {
     spdlog::set_level(spdlog::level::critical);
 
-    ob::OrderBook order_book;
+    ob::OrderBook<Backend> order_book;
 
     ob::Order order_buy1{1, ob::OrderSide::BUY, 10000, 5};
     order_book.bid(order_buy1);
 
-    ob::Order order_buy2{1, ob::OrderSide::BUY, 10000, 6};
+    ob::Order order_buy2{2, ob::OrderSide::BUY, 10000, 6};
     order_book.bid(order_buy2);
 
     ob::Order order_sell{3, ob::OrderSide::SELL, 1, 5};
@@ -42,6 +58,158 @@ static void BM_Ask_Exec(benchmark::State& state) {
         order_book.ask(order_sell);
     }
 }
-BENCHMARK(BM_Ask_Exec);
+BENCHMARK_TEMPLATE(BM_Ask_Exec, ob::MapBackend);
+BENCHMARK_TEMPLATE(BM_Ask_Exec, ob::FlatBackend);
+
+template <typename Backend>
+static void BM_Depth(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+
+    // 100 levels of 10 orders each
+    ob::OrderBook<Backend> order_book;
+    for (ob::OrderId id = 0; id < 1000; ++id) {
+        ob::Order order{id, ob::OrderSide::BUY, 10, 1000 - id % 100};
+        order_book.bid(order);
+    }
+
+    ob::DepthLevel levels[10];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            order_book.depth(ob::OrderSide::BUY, levels, 10));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_TEMPLATE(BM_Depth, ob::MapBackend);
+BENCHMARK_TEMPLATE(BM_Depth, ob::FlatBackend);
+
+//! Warm start of a book with 100k resting orders, from a snapshot.
+template <typename Backend>
+static void BM_LoadSnapshot(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+
+    ob::OrderBook<Backend> order_book;
+    for (ob::OrderId id = 0; id < 100000; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, 10, side == ob::OrderSide::BUY
+                                          ? 1000 - id % 500
+                                          : 1001 + id % 500};
+        order_book.place_order(order);
+    }
+    std::ostringstream stream(std::ios::binary);
+    order_book.save_snapshot(stream);
+    auto const data = stream.str();
+
+    for (auto _ : state) {
+        ob::OrderBook<Backend> restored;
+        benchmark::DoNotOptimize(restored.load_snapshot(data));
+    }
+    state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK_TEMPLATE(BM_LoadSnapshot, ob::MapBackend)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LoadSnapshot, ob::FlatBackend)
+    ->Unit(benchmark::kMillisecond);
+
+//! Running sums over a level of resting quantities, until the last one.
+template <std::size_t (*Kernel)(ob::Quantity const*, std::size_t,
+                                std::int64_t)>
+static void BM_PrefixWithin(benchmark::State& state) {
+    if (Kernel == ob::detail::prefix_within_avx2 && !ob::detail::has_avx2()) {
+        state.SkipWithError("This CPU does not support AVX2");
+        return;
+    }
+    auto const count = static_cast<std::size_t>(state.range(0));
+    std::vector<ob::Quantity> quantities(count);
+    std::int64_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        quantities[i] = static_cast<ob::Quantity>(1 + i % 100);
+        total += quantities[i];
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            Kernel(quantities.data(), quantities.size(), total - 1));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_PrefixWithin, ob::detail::prefix_within_scalar)
+    ->Arg(8)
+    ->Arg(64)
+    ->Arg(1024);
+BENCHMARK_TEMPLATE(BM_PrefixWithin, ob::detail::prefix_within_avx2)
+    ->Arg(8)
+    ->Arg(64)
+    ->Arg(1024);
+
+//! An aggressive order filling a whole level of small resting orders.
+template <typename Backend>
+static void BM_FillLevel(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    ob::OrderBook<Backend> order_book;
+    auto const orders = static_cast<ob::OrderId>(state.range(0));
+    ob::OrderId id = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ob::Quantity total = 0;
+        for (ob::OrderId i = 0; i < orders; ++i) {
+            ob::Order ask{++id, ob::OrderSide::SELL, 1 + i % 5, 100};
+            order_book.ask(ask);
+            total += ask.quantity;
+        }
+        // Exactly the level, so that the book is empty again
+        ob::Order bid{++id, ob::OrderSide::BUY, total, 100};
+        state.ResumeTiming();
+
+        order_book.bid(bid);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_FillLevel, ob::MapBackend)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_FillLevel, ob::FlatBackend)->Arg(16)->Arg(1024);
+
+/** \brief Reading every line of a large CSV text.
+ *
+ * Argument: parsing threads, 0 for a single OrderReader on this thread.
+ */
+static void BM_ReadOrders(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    constexpr int lines = 1 << 20;
+    std::string text;
+    for (int i = 0; i < lines; ++i) {
+        text += "A," + std::to_string(i) + (i % 2 ? ",B," : ",S,") +
+                std::to_string(1 + i % 100) + "," +
+                std::to_string(900 + i % 200) + "\n";
+    }
+    auto const threads = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state) {
+        std::int64_t quantity = 0;
+        if (threads == 0) {
+            ob::OrderReader reader(text);
+            for (ob::ParsedLine line; reader.next(line);) {
+                quantity += line.order.quantity;
+            }
+        } else {
+            ob::ParallelOrderReader reader(text, threads);
+            while (auto const batch = reader.next()) {
+                for (auto const& line : *batch) {
+                    quantity += line.order.quantity;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(quantity);
+    }
+    state.SetItemsProcessed(state.iterations() * lines);
+    state.SetBytesProcessed(state.iterations() *
+                            static_cast<std::int64_t>(text.size()));
+}
+BENCHMARK(BM_ReadOrders)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
\ No newline at end of file
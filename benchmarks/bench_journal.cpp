@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include "journal.h"
+#include "spdlog/spdlog.h"
+
+/**
+ * Journal entries made durable, for each batching policy: a batch size of 0
+ * syncs every entry, otherwise the flusher syncs up to that many entries at
+ * once. Commit latency is measured from an append to the end of its sync.
+ */
+static void BM_Journal(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    auto const batch = static_cast<std::size_t>(state.range(0));
+    auto const entries = batch == 0 ? 1000 : 100000;
+    auto const path =
+        std::filesystem::temp_directory_path() / "ob_journal_bench";
+
+    ob::journal::WriterConfig config;
+    config.group_commit = batch != 0;
+    config.batch_size = batch;
+    ob::journal::WriterStats stats;
+    for (auto _ : state) {
+        std::filesystem::remove(path);
+        ob::journal::Writer writer(path.string(), config);
+        for (ob::OrderId id = 0; id < entries; ++id) {
+            writer.append(ob::OrderType::NEW,
+                          ob::Order{id, ob::OrderSide::BUY, 10, 1000});
+        }
+        writer.sync();
+        stats = writer.stats();
+    }
+    std::filesystem::remove(path);
+
+    state.SetItemsProcessed(state.iterations() * entries);
+    state.counters["syncs"] = static_cast<double>(stats.syncs);
+    state.counters["commit_mean_us"] =
+        stats.syncs == 0 ? 0.0
+                         : static_cast<double>(stats.total_commit_ns) /
+                               static_cast<double>(stats.syncs) / 1000.0;
+    state.counters["commit_max_us"] =
+        static_cast<double>(stats.max_commit_ns) / 1000.0;
+}
+BENCHMARK(BM_Journal)
+    ->Arg(0)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(4096)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,77 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "book_manager.h"
+#include "spdlog/spdlog.h"
+
+//! Orders spread over many symbols, with prices crossing often enough to
+//! trade.
+static std::vector<std::pair<std::string, ob::Order>> make_orders(
+    std::size_t symbols, std::size_t orders) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<std::size_t> symbol(0, symbols - 1);
+    std::uniform_int_distribution<ob::Price> price(990, 1010);
+    std::uniform_int_distribution<ob::Quantity> quantity(1, 100);
+
+    std::vector<std::pair<std::string, ob::Order>> result;
+    result.reserve(orders);
+    for (std::size_t i = 0; i < orders; ++i) {
+        auto const side =
+            random() % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        result.emplace_back(
+            "SYM" + std::to_string(symbol(random)),
+            ob::Order{static_cast<ob::OrderId>(i), side, quantity(random),
+                      price(random)});
+    }
+    return result;
+}
+
+/**
+ * Throughput of the whole manager, from submission to the end of matching,
+ * for a growing number of shards. Compare the orders/s counters to see how
+ * matching scales with cores.
+ *
+ * Starting the workers and creating the books is not timed: each iteration
+ * gets a manager whose books already exist, and stops it untimed.
+ */
+static void BM_BookManager(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    constexpr std::size_t symbols = 1000;
+    static auto const orders = make_orders(symbols, 1 << 20);
+
+    ob::ManagerConfig config;
+    config.shards = static_cast<std::size_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto manager = std::make_unique<ob::BookManager<>>(config);
+        // Cancelling an unknown order creates the book and nothing else
+        for (std::size_t i = 0; i < symbols; ++i) {
+            manager->submit("SYM" + std::to_string(i), ob::OrderType::CANCEL,
+                            {-1, ob::OrderSide::BUY, 1, 1000});
+        }
+        manager->wait();
+        state.ResumeTiming();
+
+        for (auto const& [symbol, order] : orders) {
+            manager->submit(symbol, ob::OrderType::NEW, order);
+        }
+        manager->wait();
+
+        state.PauseTiming();
+        manager.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() *
+                            static_cast<std::int64_t>(orders.size()));
+}
+BENCHMARK(BM_BookManager)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "order_book.h"
+#include "spdlog/spdlog.h"
+#include "workload.h"
+
+namespace {
+
+//! Calls to the global operator new, by any thread.
+std::atomic<std::size_t> heap_allocations{0};
+
+}  // namespace
+
+// Count every heap allocation of the benchmark binary
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+//! Place the new orders of a flow and cancel the others.
+template <typename Book>
+static void process(Book& book, std::vector<obb::Message> const& flow) {
+    for (auto const& message : flow) {
+        auto order = message.order;
+        if (message.type == ob::OrderType::NEW) {
+            book.place_order(order);
+        } else {
+            book.cancel(order.id);
+        }
+    }
+}
+
+/** \brief Heap allocations of a warm book.
+ *
+ * The book first processes a flow of orders and cancels, then the timed part
+ * processes the rest of the same flow. Argument: number of levels on each
+ * side. The `allocs/op` counter is the average number of heap allocations per
+ * message once warm, which should be 0.
+ */
+template <typename Backend>
+static void BM_WarmAllocations(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    obb::WorkloadConfig config;
+    config.depth = static_cast<std::size_t>(state.range(0));
+    config.orders_per_level = 4;
+    obb::Workload workload(config);
+    auto const prefill = workload.prefill();
+    auto const warm_up = workload.generate(1 << 16);
+    auto const flow = workload.generate(1 << 16);
+
+    std::size_t messages = 0;
+    std::size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto book = std::make_unique<ob::OrderBook<Backend>>(
+            ob::LadderConfig{config.start_price - (1 << 12), 1, 1 << 13});
+        process(*book, prefill);
+        process(*book, warm_up);
+        auto const before = heap_allocations.load();
+        state.ResumeTiming();
+
+        process(*book, flow);
+
+        state.PauseTiming();
+        allocations += heap_allocations.load() - before;
+        messages += flow.size();
+        book.reset();
+        state.ResumeTiming();
+    }
+    state.counters["allocs/op"] =
+        static_cast<double>(allocations) / static_cast<double>(messages);
+    state.counters["orders/s"] = benchmark::Counter(
+        static_cast<double>(messages), benchmark::Counter::kIsRate);
+}
+BENCHMARK_TEMPLATE(BM_WarmAllocations, ob::MapBackend)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_WarmAllocations, ob::FlatBackend)->Arg(10)->Arg(100);
@@ -0,0 +1,36 @@
+#include <benchmark/benchmark.h>
+
+#include "pipeline.h"
+#include "spdlog/spdlog.h"
+
+/**
+ * Orders pushed through the order ring to the matching thread, with their
+ * events pushed through the event ring to a reporting thread. The counters
+ * show the time spent by orders in the order ring.
+ */
+template <typename Wait>
+static void BM_Pipeline(benchmark::State& state) {
+    spdlog::set_level(spdlog::level::critical);
+    constexpr ob::OrderId orders = 1 << 18;
+
+    ob::QueueLatency latency;
+    for (auto _ : state) {
+        ob::Pipeline<ob::MapBackend, ob::NullSink, Wait> pipeline;
+        for (ob::OrderId id = 0; id < orders; ++id) {
+            auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+            pipeline.submit(ob::OrderType::NEW,
+                            ob::Order{id, side, id % 7 + 1, 990 + id % 20});
+        }
+        pipeline.stop();
+        latency = pipeline.latency();
+    }
+    state.SetItemsProcessed(state.iterations() * orders);
+    state.counters["queue_mean_ns"] = latency.mean_ns();
+    state.counters["queue_max_ns"] = static_cast<double>(latency.max_ns);
+}
+BENCHMARK_TEMPLATE(BM_Pipeline, ob::BackOff)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Pipeline, ob::BusySpin)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,275 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "order_book.h"
+#include "spdlog/spdlog.h"
+#include "workload.h"
+
+/** \brief Book prefilled from a workload, and the flow that follows.
+ *
+ * Arguments: depth (levels per side), orders per level, cancel percentage.
+ * Books are built and destroyed with the timer paused, and the counters
+ * report orders per second.
+ */
+template <typename Backend>
+class WorkloadFixture : public benchmark::Fixture {
+   public:
+    using Book = ob::OrderBook<Backend>;
+
+    void SetUp(benchmark::State const& state) override {
+        spdlog::set_level(spdlog::level::critical);
+
+        this->config.depth = static_cast<std::size_t>(state.range(0));
+        this->config.orders_per_level =
+            static_cast<std::size_t>(state.range(1));
+        this->config.cancel_ratio = static_cast<double>(state.range(2)) / 100;
+        obb::Workload workload(this->config);
+        this->prefill = workload.prefill();
+        this->flow = workload.generate(flow_size);
+    }
+
+    void TearDown(benchmark::State const&) override {
+        this->book.reset();
+        this->prefill.clear();
+        this->flow.clear();
+    }
+
+    //! The whole flow: new orders, some marketable, and cancels.
+    void run_flow(benchmark::State& state) {
+        std::size_t orders = 0;
+        for (auto _ : state) {
+            this->fresh_book(state);
+            process(*this->book, this->flow);
+            orders += this->flow.size();
+        }
+        count(state, orders);
+    }
+
+    //! Cancel every resting order, in random order.
+    void run_cancels(benchmark::State& state) {
+        std::vector<ob::OrderId> ids;
+        for (auto const& message : this->prefill) {
+            ids.push_back(message.order.id);
+        }
+        std::shuffle(std::begin(ids), std::end(ids), std::mt19937_64(7));
+
+        std::size_t orders = 0;
+        for (auto _ : state) {
+            this->fresh_book(state);
+            for (auto id : ids) {
+                this->book->cancel(id);
+            }
+            orders += ids.size();
+        }
+        count(state, orders);
+    }
+
+    /** \brief Amend every resting order once, in random order.
+     *
+     * Half of the amends lower the quantity, which keeps the order's place,
+     * the other half move the order one tick away from the mid.
+     */
+    void run_amends(benchmark::State& state) {
+        std::vector<ob::Order> amends;
+        for (auto const& message : this->prefill) {
+            auto order = message.order;
+            if (amends.size() % 2 == 0 && order.quantity > 1) {
+                --order.quantity;
+            } else {
+                order.price += order.side == ob::OrderSide::BUY ? -1 : 1;
+            }
+            amends.push_back(order);
+        }
+        std::shuffle(std::begin(amends), std::end(amends),
+                     std::mt19937_64(7));
+
+        std::size_t orders = 0;
+        for (auto _ : state) {
+            this->fresh_book(state);
+            for (auto amend : amends) {
+                this->book->amend(amend);
+            }
+            orders += amends.size();
+        }
+        count(state, orders);
+    }
+
+    //! One order sweeping every ask level.
+    void run_sweep(benchmark::State& state) {
+        auto const last_ask =
+            this->config.start_price +
+            static_cast<ob::Price>(this->config.depth);
+
+        std::size_t filled = 0;
+        for (auto _ : state) {
+            this->fresh_book(state);
+            auto const resting = this->book->order_index.size();
+            ob::Order sweep{0, ob::OrderSide::BUY,
+                            std::numeric_limits<ob::Quantity>::max(),
+                            last_ask};
+            this->book->bid(sweep);
+
+            // The sweeping order rests once every ask is filled
+            filled += resting + 1 - this->book->order_index.size();
+        }
+        count(state, filled);
+    }
+
+    //! How run_burst submits the orders.
+    enum class Burst { Single, Batch, Auction };
+
+    /** \brief Only the new orders of the flow, as an opening burst.
+     *
+     * Placed one at a time, as one batch, or as one batch collected by a
+     * call auction then uncrossed.
+     */
+    void run_burst(benchmark::State& state, Burst burst) {
+        std::vector<ob::Order> orders;
+        for (auto const& message : this->flow) {
+            if (message.type == ob::OrderType::NEW) {
+                orders.push_back(message.order);
+            }
+        }
+
+        std::vector<ob::Order> batch(orders.size());
+        std::size_t placed = 0;
+        for (auto _ : state) {
+            this->fresh_book(state);
+            state.PauseTiming();
+            std::copy(std::begin(orders), std::end(orders),
+                      std::begin(batch));
+            state.ResumeTiming();
+
+            // Since we use an enum, we would get a warning if our switch
+            // wasn't exhaustive
+            switch (burst) {
+                case Burst::Single:
+                    for (auto& order : batch) {
+                        this->book->place_order(order);
+                    }
+                    break;
+                case Burst::Batch:
+                    this->book->submit_batch(batch.data(), batch.size());
+                    break;
+                case Burst::Auction:
+                    this->book->open_auction();
+                    this->book->submit_batch(batch.data(), batch.size());
+                    this->book->uncross();
+                    break;
+            }
+            placed += batch.size();
+        }
+        count(state, placed);
+    }
+
+   private:
+    static constexpr std::size_t flow_size = 1 << 16;
+
+    //! Replace the book by one holding the prefilled orders.
+    void fresh_book(benchmark::State& state) {
+        state.PauseTiming();
+        this->book = std::make_unique<Book>();
+        process(*this->book, this->prefill);
+        state.ResumeTiming();
+    }
+
+    static void process(Book& book, std::vector<obb::Message> const& flow) {
+        for (auto const& message : flow) {
+            auto order = message.order;
+            switch (message.type) {
+                case ob::OrderType::NEW:
+                    book.place_order(order);
+                    break;
+                case ob::OrderType::CANCEL:
+                    book.cancel(order.id);
+                    break;
+                case ob::OrderType::MODIFY:
+                    book.amend(order);
+                    break;
+            }
+        }
+    }
+
+    static void count(benchmark::State& state, std::size_t orders) {
+        state.counters["orders/s"] = benchmark::Counter(
+            static_cast<double>(orders), benchmark::Counter::kIsRate);
+    }
+
+    obb::WorkloadConfig config;
+    std::vector<obb::Message> prefill;
+    std::vector<obb::Message> flow;
+    std::unique_ptr<Book> book;
+};
+
+//! Depth, orders per level and cancel percentage.
+static void workload_args(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgsProduct({{10, 100, 1000}, {1, 10}, {0, 20, 50}})
+        ->Unit(benchmark::kMillisecond);
+}
+
+//! Depth and orders per level, bursts have no cancels.
+static void burst_args(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgsProduct({{10, 100, 1000}, {1, 10}, {0}})
+        ->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Flow_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_flow(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Flow_Map)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Flow_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_flow(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Flow_Flat)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Cancel_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_cancels(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Cancel_Map)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Cancel_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_cancels(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Cancel_Flat)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Amend_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_amends(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Amend_Map)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Amend_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_amends(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Amend_Flat)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Sweep_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_sweep(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Sweep_Map)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Sweep_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_sweep(state); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Sweep_Flat)->Apply(workload_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Burst_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Single); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Burst_Map)->Apply(burst_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Burst_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Single); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Burst_Flat)->Apply(burst_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Batch_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Batch); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Batch_Map)->Apply(burst_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Batch_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Batch); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Batch_Flat)->Apply(burst_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Auction_Map, ob::MapBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Auction); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Auction_Map)->Apply(burst_args);
+
+BENCHMARK_TEMPLATE_DEFINE_F(WorkloadFixture, Auction_Flat, ob::FlatBackend)
+(benchmark::State& state) { this->run_burst(state, Burst::Auction); }
+BENCHMARK_REGISTER_F(WorkloadFixture, Auction_Flat)->Apply(burst_args);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "order.h"
+
+//! Synthetic order flow for benchmarks
+namespace obb {
+
+//! Shape of a synthetic order flow.
+struct WorkloadConfig final {
+    std::uint64_t seed = 42;           //!< Same seed, same orders
+    ob::Price start_price = 10000;     //!< Initial mid price
+    double walk_probability = 0.1;     //!< Chance the mid moves, per order
+    std::size_t depth = 10;            //!< Passive orders are this close to mid
+    std::size_t orders_per_level = 1;  //!< When prefilling the book
+    double arrival_rate = 1e6;         //!< Mean orders per second (Poisson)
+    double cancel_ratio = 0.2;         //!< Share of cancels among messages
+    double marketable_ratio = 0.1;     //!< Share of new orders that cross
+    ob::Quantity max_quantity = 100;   //!< Quantities are 1 to this
+};
+
+//! A message of the flow, with its arrival time.
+struct Message final {
+    ob::OrderType type;
+    ob::Order order;
+    std::uint64_t timestamp_ns;  //!< Since the start of the flow
+};
+
+/** \brief Seeded generator of realistic order flow.
+ *
+ * The mid price follows a random walk. Passive orders rest within `depth`
+ * ticks of the mid, marketable ones cross the whole visible depth. Cancels
+ * target a random order sent earlier, which may have been filled already.
+ * Arrival times follow a Poisson process.
+ */
+class Workload final {
+   public:
+    explicit Workload(WorkloadConfig const &config)
+        : config_(config),
+          random_(config.seed),
+          mid_(config.start_price),
+          arrival_(config.arrival_rate) {}
+
+    /** \brief Orders filling `depth` levels on each side of the mid, with
+     *         `orders_per_level` orders each.
+     */
+    std::vector<Message> prefill() {
+        std::vector<Message> result;
+        for (std::size_t level = 1; level <= this->config_.depth; ++level) {
+            for (std::size_t i = 0; i < this->config_.orders_per_level; ++i) {
+                auto const offset = static_cast<ob::Price>(level);
+                result.push_back(this->add(ob::OrderSide::BUY,
+                                           this->mid_ - offset));
+                result.push_back(this->add(ob::OrderSide::SELL,
+                                           this->mid_ + offset));
+            }
+        }
+        return result;
+    }
+
+    //! Next message of the flow.
+    Message next() {
+        if (this->chance(this->config_.walk_probability)) {
+            this->mid_ += this->chance(0.5) ? 1 : -1;
+        }
+
+        if (!this->live_.empty() && this->chance(this->config_.cancel_ratio)) {
+            // Swap-remove a random earlier order
+            std::uniform_int_distribution<std::size_t> pick(
+                0, this->live_.size() - 1);
+            auto const index = pick(this->random_);
+            auto const order = this->live_[index];
+            this->live_[index] = this->live_.back();
+            this->live_.pop_back();
+            return this->stamp(Message{ob::OrderType::CANCEL, order, 0});
+        }
+
+        auto const side =
+            this->chance(0.5) ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        auto const sign = side == ob::OrderSide::BUY ? 1 : -1;
+        auto const depth = static_cast<ob::Price>(this->config_.depth);
+        if (this->chance(this->config_.marketable_ratio)) {
+            return this->add(side, this->mid_ + sign * depth);
+        }
+        std::uniform_int_distribution<ob::Price> offset(1, depth);
+        return this->add(side, this->mid_ - sign * offset(this->random_));
+    }
+
+    //! The next `count` messages.
+    std::vector<Message> generate(std::size_t count) {
+        std::vector<Message> result;
+        result.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            result.push_back(this->next());
+        }
+        return result;
+    }
+
+   private:
+    bool chance(double probability) {
+        return std::uniform_real_distribution<double>(0, 1)(this->random_) <
+               probability;
+    }
+
+    Message add(ob::OrderSide side, ob::Price price) {
+        std::uniform_int_distribution<ob::Quantity> quantity(
+            1, this->config_.max_quantity);
+        ob::Order order{this->next_id_++, side, quantity(this->random_),
+                        price};
+        this->live_.push_back(order);
+        return this->stamp(Message{ob::OrderType::NEW, order, 0});
+    }
+
+    Message stamp(Message message) {
+        this->clock_ns_ += this->arrival_(this->random_) * 1e9;
+        message.timestamp_ns = static_cast<std::uint64_t>(this->clock_ns_);
+        return message;
+    }
+
+    WorkloadConfig config_;
+    std::mt19937_64 random_;
+    ob::Price mid_;
+    std::exponential_distribution<double> arrival_;
+    double clock_ns_ = 0;
+    ob::OrderId next_id_ = 1;
+    std::vector<ob::Order> live_;  //!< Orders that may still be cancelled
+};
+
+}  // namespace obb
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "order.h"
+#include "price_ladder.h"
+
+namespace ob {
+
+//! Outcome of a call auction.
+struct AuctionResult final {
+    Price price;           //!< Equilibrium price, 0 if nothing executed
+    std::int64_t volume;   //!< Quantity executed, on each side
+    std::int64_t surplus;  //!< Bids minus asks left at that price
+};
+
+namespace detail {
+
+/** \brief Price at which a crossed book executes the most quantity.
+ *
+ * `bids` are the bid levels at or above the best ask, best first, and `asks`
+ * the ask levels at or below the best bid, best first: the other levels
+ * cannot execute at any candidate price.
+ *
+ * Among the prices executing the most, the one leaving the smallest surplus
+ * wins. If several remain, buyers left over push the price up (the highest
+ * one is taken), sellers left over push it down (the lowest one), and
+ * otherwise the middle one is taken (the higher one if there are two).
+ */
+AuctionResult equilibrium(std::vector<DepthLevel> const &bids,
+                          std::vector<DepthLevel> const &asks);
+
+}  // namespace detail
+
+}  // namespace ob
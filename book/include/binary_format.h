@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "order.h"
+
+//! Fixed-width binary files of order messages
+namespace ob::binary {
+
+/** \brief Layout of a binary orders file.
+ *
+ * Every integer is little-endian. The file starts with a 16 bytes header:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 8    | magic, "OBORDERS"                        |
+ * | 8      | 2    | version                                  |
+ * | 10     | 2    | record size, 16 or 24                    |
+ * | 12     | 4    | flags, bit 0 set if records have a time  |
+ *
+ * followed by fixed-size records:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 1    | type, same letter as in the CSV files    |
+ * | 1      | 1    | side, 'B' or 'S'                         |
+ * | 2      | 1    | time in force, 0 GTC, 1 IOC, 2 FOK       |
+ * | 3      | 1    | reserved, 0                              |
+ * | 4      | 4    | order ID                                 |
+ * | 8      | 4    | quantity                                 |
+ * | 12     | 4    | price                                    |
+ * | 16     | 8    | timestamp, only with the timestamp flag  |
+ */
+constexpr char magic[8] = {'O', 'B', 'O', 'R', 'D', 'E', 'R', 'S'};
+constexpr std::uint16_t version = 1;
+constexpr std::size_t header_size = 16;
+constexpr std::size_t record_size = 16;
+constexpr std::size_t timestamped_record_size = 24;
+constexpr std::uint32_t timestamps_flag = 1;
+
+//! A decoded record.
+struct Record final {
+    OrderType type;           //!< New order, cancel or amend
+    Order order;              //!< The order message
+    std::uint64_t timestamp;  //!< 0 when the file has no timestamps
+};
+
+//! Whether the data starts like a binary orders file.
+bool has_magic(std::string_view data);
+
+//! Write the first `record_size` bytes of a record, without a timestamp.
+void encode(char *data, OrderType, Order const &);
+
+/** \brief Decode the first `record_size` bytes of a record, in place.
+ *
+ * The timestamp of the record is left alone.
+ *
+ * \return false if the record has an invalid type, side or time in force.
+ */
+bool decode(char const *data, Record &);
+
+//! Write records to a stream, after the header.
+class Writer final {
+   public:
+    Writer(std::ostream &, bool timestamps);
+
+    void write(OrderType, Order const &, std::uint64_t timestamp = 0);
+
+   private:
+    std::ostream &stream_;
+    bool timestamps_;
+};
+
+/** \brief Read records in place, for example from a MappedFile.
+ *
+ * Records are decoded on access, the data is never copied.
+ */
+class Reader final {
+   public:
+    explicit Reader(std::string_view data);
+
+    //! Why the file cannot be read, or null if it is valid.
+    char const *error() const { return this->error_; }
+
+    //! Number of records in the file.
+    std::size_t size() const { return this->size_; }
+
+    bool has_timestamps() const {
+        return this->record_size_ == timestamped_record_size;
+    }
+
+    //! Byte offset of a record in the file, to report errors.
+    std::size_t offset(std::size_t index) const {
+        return header_size + index * this->record_size_;
+    }
+
+    /** \brief Decode a record.
+     *
+     * \return false if the record has an invalid type, side or time in
+     *         force.
+     */
+    bool read(std::size_t index, Record &) const;
+
+   private:
+    char const *records_ = nullptr;  //!< First record, after the header
+    std::size_t record_size_ = record_size;
+    std::size_t size_ = 0;
+    char const *error_ = nullptr;
+};
+
+}  // namespace ob::binary
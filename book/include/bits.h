@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ob::detail {
+
+//! Index of the lowest set bit. The word must not be zero.
+inline std::size_t lowest_bit(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+}
+
+//! Index of the highest set bit. The word must not be zero.
+inline std::size_t highest_bit(std::uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return index;
+#else
+    return 63 - static_cast<std::size_t>(__builtin_clzll(word));
+#endif
+}
+
+//! Hint that the cache line holding `address` will be read soon.
+inline void prefetch(void const *address) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<char const *>(address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+}  // namespace ob::detail
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "order.h"
+#include "order_book.h"
+#include "price_ladder.h"
+#include "thread_affinity.h"
+
+namespace ob {
+
+//! How a BookManager spreads its books over threads.
+struct ManagerConfig final {
+    std::size_t shards = 1;             //!< Number of worker threads
+    bool pin_threads = true;            //!< Pin worker `i` to core `i`
+    std::size_t batch_size = 256;       //!< Orders handed over at once
+    std::size_t queue_limit = 1 << 16;  //!< Orders queued before submit waits
+    LadderConfig ladder;                //!< Price range of every book
+};
+
+/** \brief One order book per symbol, matched by a pool of worker threads.
+ *
+ * Symbols are numbered in order of first appearance and dealt round-robin
+ * to the shards, one worker thread each. A book is only ever touched by the
+ * worker of its shard, so matching needs no locks: the only synchronisation
+ * is the hand-over of a batch of orders from the submitting thread to a
+ * worker, once every `batch_size` orders.
+ *
+ * Orders for one symbol are matched in the order they were submitted.
+ * Orders for different symbols are independent and may be matched in any
+ * order.
+ *
+ * Only one thread may submit orders. The books can be read once the manager
+ * is stopped, or waited for.
+ *
+ * If the Sink can be built from a `std::string_view`, e.g. LogSink, the sink
+ * of each book is built from its symbol.
+ */
+template <typename Backend = MapBackend, typename Sink = NullSink>
+class BookManager final {
+   public:
+    using Book = OrderBook<Backend, Sink>;
+
+    //! Start the worker threads.
+    explicit BookManager(ManagerConfig const &config = {});
+
+    //! Process the orders still queued, then join the workers.
+    ~BookManager();
+
+    BookManager(BookManager const &) = delete;
+    BookManager &operator=(BookManager const &) = delete;
+
+    /** \brief Queue an order for the book of its symbol.
+     *
+     * The order is copied. It is handed over to its worker once enough
+     * orders are queued for that worker, or on flush() and stop().
+     */
+    void submit(std::string_view symbol, OrderType, Order const &);
+
+    //! Hand over every queued order to the workers, without waiting.
+    void flush();
+
+    /** \brief Wait until every submitted order is processed, keeping the
+     *         workers.
+     *
+     * The books can be read until the next submit().
+     */
+    void wait();
+
+    //! Wait until every submitted order is processed, and stop the workers.
+    void stop();
+
+    std::size_t shard_count() const { return this->shards_.size(); }
+
+    std::size_t symbol_count() const { return this->symbols_.size(); }
+
+    /** \brief Call `f(symbol, book)` on every book, in order of first
+     *         appearance of the symbols.
+     *
+     * The manager must be stopped, or waited for.
+     */
+    template <typename F>
+    void for_each_book(F &&f) const;
+
+   private:
+    //! An order on its way to a worker.
+    struct Message final {
+        std::uint32_t book;  //!< Index of the book inside its shard
+        OrderType type;
+        Order order;
+    };
+
+    //! A worker thread and the books it owns. Aligned so that two shards
+    //! never share a cache line.
+    struct alignas(64) Shard final {
+        std::mutex mutex;
+        std::condition_variable ready;  //!< Orders arrived, or stopping
+        std::condition_variable space;  //!< The worker took the queue
+        std::condition_variable idle;   //!< The worker ran out of orders
+        std::vector<Message> queue;     //!< Guarded by the mutex
+        //! Symbols of the books to create, guarded by the mutex
+        std::vector<std::string_view> symbols;
+        bool stopping = false;  //!< Guarded by the mutex
+        bool busy = false;      //!< Matching a batch, guarded by the mutex
+
+        std::vector<Message> pending;  //!< Submitting thread only
+        //! Symbols first seen since the last hand-over, same thread
+        std::vector<std::string_view> new_symbols;
+        std::vector<std::unique_ptr<Book>> books;  //!< Worker thread only
+        std::thread worker;
+    };
+
+    //! Number of a symbol, assigned on first use.
+    std::size_t symbol_id(std::string_view symbol);
+
+    //! Move the pending orders of a shard to its queue.
+    void hand_over(Shard &);
+
+    //! Body of a worker thread.
+    void run(Shard &, std::size_t core);
+
+    ManagerConfig config_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    //! Keys view the symbols, which a deque never moves
+    std::unordered_map<std::string_view, std::size_t> symbol_ids_;
+    std::deque<std::string> symbols_;  //!< By number
+    std::size_t last_id_ = 0;           //!< Symbol of the last order
+    bool stopped_ = false;
+};
+
+/**
+ * Library implementation
+ */
+
+template <typename Backend, typename Sink>
+BookManager<Backend, Sink>::BookManager(ManagerConfig const &config)
+    : config_(config) {
+    auto const shards = config.shards == 0 ? 1 : config.shards;
+    for (std::size_t i = 0; i < shards; ++i) {
+        this->shards_.push_back(std::make_unique<Shard>());
+        this->shards_.back()->pending.reserve(config.batch_size);
+    }
+    for (std::size_t i = 0; i < shards; ++i) {
+        auto &shard = *this->shards_[i];
+        shard.worker = std::thread([this, &shard, i] { this->run(shard, i); });
+    }
+}
+
+template <typename Backend, typename Sink>
+BookManager<Backend, Sink>::~BookManager() {
+    this->stop();
+}
+
+template <typename Backend, typename Sink>
+std::size_t BookManager<Backend, Sink>::symbol_id(std::string_view symbol) {
+    // Orders often come in runs for the same symbol
+    if (!this->symbols_.empty() && this->symbols_[this->last_id_] == symbol) {
+        return this->last_id_;
+    }
+
+    // Looked up without copying the symbol
+    auto found = this->symbol_ids_.find(symbol);
+    if (found == std::end(this->symbol_ids_)) {
+        auto const &stored = this->symbols_.emplace_back(symbol);
+        found =
+            this->symbol_ids_.emplace(stored, this->symbols_.size() - 1).first;
+
+        // The worker can read the stored symbol later, it does not move
+        auto &shard = *this->shards_[found->second % this->shards_.size()];
+        shard.new_symbols.emplace_back(stored);
+    }
+    this->last_id_ = found->second;
+    return this->last_id_;
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::submit(std::string_view symbol,
+                                        OrderType type, Order const &order) {
+    auto const id = this->symbol_id(symbol);
+    auto const shards = this->shards_.size();
+    auto &shard = *this->shards_[id % shards];
+    shard.pending.push_back(
+        Message{static_cast<std::uint32_t>(id / shards), type, order});
+    if (shard.pending.size() >= this->config_.batch_size) {
+        this->hand_over(shard);
+    }
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::hand_over(Shard &shard) {
+    if (shard.pending.empty()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(shard.mutex);
+        // Wait for a slow worker rather than queueing without bounds
+        shard.space.wait(lock, [this, &shard] {
+            return shard.queue.size() < this->config_.queue_limit;
+        });
+        shard.queue.insert(std::end(shard.queue), std::begin(shard.pending),
+                           std::end(shard.pending));
+        shard.symbols.insert(std::end(shard.symbols),
+                             std::begin(shard.new_symbols),
+                             std::end(shard.new_symbols));
+    }
+    shard.ready.notify_one();
+    shard.pending.clear();
+    shard.new_symbols.clear();
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::flush() {
+    for (auto &shard : this->shards_) {
+        this->hand_over(*shard);
+    }
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::wait() {
+    this->flush();
+    for (auto &shard : this->shards_) {
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        shard->idle.wait(lock, [&shard] {
+            return shard->queue.empty() && !shard->busy;
+        });
+    }
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::stop() {
+    if (this->stopped_) {
+        return;
+    }
+    this->flush();
+    for (auto &shard : this->shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stopping = true;
+        }
+        shard->ready.notify_one();
+    }
+    for (auto &shard : this->shards_) {
+        shard->worker.join();
+    }
+    this->stopped_ = true;
+}
+
+template <typename Backend, typename Sink>
+void BookManager<Backend, Sink>::run(Shard &shard, std::size_t core) {
+    if (this->config_.pin_threads) {
+        pin_current_thread(core);
+    }
+
+    // Swapped with the queue, so both keep their capacity
+    std::vector<Message> batch;
+    std::vector<std::string_view> symbols;  //!< Of the books, by index
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.busy = false;
+            if (shard.queue.empty()) {
+                shard.idle.notify_all();
+            }
+            shard.ready.wait(lock, [&shard] {
+                return !shard.queue.empty() || shard.stopping;
+            });
+            if (shard.queue.empty()) {
+                return;
+            }
+            batch.swap(shard.queue);
+            shard.busy = true;
+            symbols.insert(std::end(symbols), std::begin(shard.symbols),
+                           std::end(shard.symbols));
+            shard.symbols.clear();
+        }
+        shard.space.notify_one();
+
+        for (auto &message : batch) {
+            if (message.book >= shard.books.size()) {
+                shard.books.resize(message.book + 1);
+            }
+            auto &book = shard.books[message.book];
+            if (!book) {
+                if constexpr (std::is_constructible_v<Sink,
+                                                      std::string_view>) {
+                    book = std::make_unique<Book>(
+                        this->config_.ladder, Sink(symbols[message.book]));
+                } else {
+                    book = std::make_unique<Book>(this->config_.ladder);
+                }
+            }
+
+            // Since we use an enum, we would get a warning if our switch
+            // wasn't exhaustive
+            switch (message.type) {
+                case OrderType::NEW:
+                    book->place_order(message.order);
+                    break;
+                case OrderType::CANCEL:
+                    book->cancel(message.order);
+                    break;
+                case OrderType::MODIFY:
+                    book->amend(message.order);
+                    break;
+            }
+        }
+        batch.clear();
+    }
+}
+
+template <typename Backend, typename Sink>
+template <typename F>
+void BookManager<Backend, Sink>::for_each_book(F &&f) const {
+    auto const shards = this->shards_.size();
+    for (std::size_t id = 0; id < this->symbols_.size(); ++id) {
+        auto const &books = this->shards_[id % shards]->books;
+        auto const index = id / shards;
+        if (index < books.size() && books[index]) {
+            f(this->symbols_[id], *books[index]);
+        }
+    }
+}
+
+}  // namespace ob
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "bits.h"
+
+namespace ob {
+
+/** \brief Distribution of latencies, in nanoseconds, in fixed memory.
+ *
+ * Log-linear buckets: values below 64 have their own bucket, and every power
+ * of two above is split in 32 buckets of equal width. A percentile is
+ * therefore off by less than 1/32 (about 3%), over the whole 64-bit range,
+ * and recording a value is a bit scan and an increment.
+ */
+class LatencyHistogram final {
+   public:
+    //! Record one measurement.
+    void record(std::uint64_t value) {
+        ++this->counts_[bucket_of(value)];
+        ++this->count_;
+        if (value > this->max_) {
+            this->max_ = value;
+        }
+    }
+
+    //! Add the measurements of another histogram to this one.
+    void merge(LatencyHistogram const &other) {
+        for (std::size_t i = 0; i < buckets; ++i) {
+            this->counts_[i] += other.counts_[i];
+        }
+        this->count_ += other.count_;
+        if (other.max_ > this->max_) {
+            this->max_ = other.max_;
+        }
+    }
+
+    std::uint64_t count() const { return this->count_; }
+
+    //! Largest value recorded, exactly.
+    std::uint64_t max() const { return this->max_; }
+
+    /** \brief Smallest value that `q` of the measurements do not exceed.
+     *
+     * `q` is between 0 and 1, e.g. 0.999 for the 99.9th percentile. The
+     * result is the upper bound of the bucket holding that measurement, and
+     * never more than max(). 0 if nothing was recorded.
+     */
+    std::uint64_t percentile(double q) const {
+        if (this->count_ == 0) {
+            return 0;
+        }
+        // Nearest rank, counting from 1
+        auto rank = static_cast<std::uint64_t>(
+            std::ceil(q * static_cast<double>(this->count_)));
+        if (rank == 0) {
+            rank = 1;
+        }
+
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < buckets; ++i) {
+            seen += this->counts_[i];
+            if (seen >= rank) {
+                auto const upper = highest_of(i);
+                return upper < this->max_ ? upper : this->max_;
+            }
+        }
+        return this->max_;
+    }
+
+   private:
+    static constexpr std::size_t sub_bits = 5;  //!< 32 buckets per power of 2
+    static constexpr std::size_t sub_count = std::size_t{1} << sub_bits;
+    //! Two rows of exact values, then one row per power of two up to 2^63
+    static constexpr std::size_t buckets = (65 - sub_bits) * sub_count;
+
+    //! Values below 2 * sub_count are exact, above we keep the top bits.
+    static std::size_t bucket_of(std::uint64_t value) {
+        if (value < 2 * sub_count) {
+            return static_cast<std::size_t>(value);
+        }
+        auto const shift = detail::highest_bit(value) - sub_bits;
+        return shift * sub_count + static_cast<std::size_t>(value >> shift);
+    }
+
+    //! Largest value falling in a bucket.
+    static std::uint64_t highest_of(std::size_t bucket) {
+        if (bucket < 2 * sub_count) {
+            return bucket;
+        }
+        auto const shift = bucket / sub_count - 1;
+        auto const top = bucket % sub_count + sub_count;
+        return ((std::uint64_t{top} + 1) << shift) - 1;
+    }
+
+    std::array<std::uint64_t, buckets> counts_{};
+    std::uint64_t count_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+/** \brief Default statistics of a book: nothing is measured.
+ *
+ * The book checks `enabled` at compile time, so it does not even read the
+ * clock.
+ */
+struct NullStats final {
+    static constexpr bool enabled = false;
+};
+
+//! Latency of each operation of a book, and how much matching it did.
+struct BookStats final {
+    static constexpr bool enabled = true;
+
+    using Clock = std::chrono::steady_clock;
+
+    LatencyHistogram place;   //!< place_order, including matching
+    LatencyHistogram cancel;  //!< cancel, found or not
+    LatencyHistogram amend;   //!< amend, including matching
+
+    std::uint64_t levels_swept = 0;   //!< Levels an incoming order traded at
+    std::uint64_t orders_filled = 0;  //!< Resting orders fully executed
+
+    //! Nanoseconds elapsed since `start`.
+    static std::uint64_t since(Clock::time_point start) {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                 start)
+                .count());
+    }
+};
+
+}  // namespace ob
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+
+#include "events.h"
+#include "limit.h"
+#include "order.h"
+
+namespace ob {
+
+/** \brief Copy of the levels of a book, kept in sync from level updates.
+ *
+ * This is what a downstream consumer of the L2 feed does: start from a
+ * snapshot (the levels and sequence number of the book at one point), then
+ * apply the batches of updates sent after it. Updates already included in
+ * the snapshot are skipped, and a missing one is detected.
+ */
+class DepthMirror final {
+   public:
+    using Bids = std::map<Price, Quantity, std::greater<Price>>;
+    using Asks = std::map<Price, Quantity, std::less<Price>>;
+
+    /** \brief Start over from a snapshot of a book.
+     *
+     * Must run on the thread of the book, between two orders.
+     */
+    template <typename Book>
+    void reset(Book const &book) {
+        this->bids_.clear();
+        this->asks_.clear();
+        book.bids.for_each_limit([this](Price price, Limit const &limit) {
+            this->bids_.emplace(price, limit.quantity());
+        });
+        book.asks.for_each_limit([this](Price price, Limit const &limit) {
+            this->asks_.emplace(price, limit.quantity());
+        });
+        this->sequence_ = book.sequence();
+    }
+
+    /** \brief Apply a batch of updates.
+     *
+     * \return false if an update is missing before this batch: the mirror
+     *         is left as it was and must be reset.
+     */
+    bool apply(LevelUpdates const &updates) {
+        for (auto const &update : updates) {
+            if (update.sequence <= this->sequence_) {
+                continue;  // Already in the snapshot
+            }
+            if (update.sequence != this->sequence_ + 1) {
+                return false;
+            }
+            this->sequence_ = update.sequence;
+
+            // Since we use an enum, we would get a warning if our switch
+            // wasn't exhaustive
+            switch (update.side) {
+                case OrderSide::BUY:
+                    set(this->bids_, update);
+                    break;
+                case OrderSide::SELL:
+                    set(this->asks_, update);
+                    break;
+            }
+        }
+        return true;
+    }
+
+    //! Sequence number of the last update applied.
+    std::uint64_t sequence() const { return this->sequence_; }
+
+    Bids const &bids() const { return this->bids_; }
+    Asks const &asks() const { return this->asks_; }
+
+   private:
+    template <typename Levels>
+    static void set(Levels &levels, LevelUpdate const &update) {
+        if (update.quantity == 0) {
+            levels.erase(update.price);
+        } else {
+            levels[update.price] = update.quantity;
+        }
+    }
+
+    Bids bids_;
+    Asks asks_;
+    std::uint64_t sequence_ = 0;
+};
+
+}  // namespace ob
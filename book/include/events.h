@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "order.h"
+
+namespace ob {
+
+//! An incoming order executed against an order resting in the book.
+struct Trade final {
+    OrderId incoming_id;         //!< Order that crossed the spread
+    OrderId resting_id;          //!< Order that was waiting in the book
+    OrderSide incoming_side;     //!< Buy/Sell, from the incoming order
+    Price price;                 //!< The resting order's, or the auction's
+    Quantity quantity;           //!< Executed quantity
+    Quantity resting_remaining;  //!< Left in the book, 0 if fully filled
+};
+
+//! An order, or what was left of it after matching, now rests in the book.
+struct OrderAdded final {
+    Order order;  //!< The order as it rests in the book
+};
+
+//! An order was removed from the book before being filled.
+struct OrderCancelled final {
+    Order order;  //!< The order as it was in the book
+};
+
+/** \brief An order stays in the book with a lower quantity.
+ *
+ * Sent when a resting order is partially filled, after the Trade, or when
+ * its quantity is amended down. A fully filled order only produces a Trade,
+ * with `resting_remaining` at 0.
+ */
+struct OrderReduced final {
+    Order order;          //!< The order as it is now in the book
+    Quantity reduced_by;  //!< How much was taken off the order
+};
+
+/** \brief New total quantity of a price level (L2 market data).
+ *
+ * Every update of a book gets the next sequence number, so a consumer can
+ * tell when it missed one.
+ */
+struct LevelUpdate final {
+    std::uint64_t sequence;  //!< One more than the previous update's
+    OrderSide side;          //!< Bids or asks
+    Price price;             //!< Price of the level
+    Quantity quantity;       //!< New total, 0 if the level is gone
+};
+
+/** \brief Every level changed by one order or cancel, coalesced.
+ *
+ * Each level appears at most once, with its final quantity. The updates are
+ * only valid during the call to the sink.
+ */
+struct LevelUpdates final {
+    LevelUpdate const *first;
+    LevelUpdate const *last;
+
+    LevelUpdate const *begin() const { return this->first; }
+    LevelUpdate const *end() const { return this->last; }
+    bool empty() const { return this->first == this->last; }
+};
+
+//! Events are copied around, they must stay plain structures.
+static_assert(std::is_trivial_v<Trade>);
+static_assert(std::is_trivial_v<OrderAdded>);
+static_assert(std::is_trivial_v<OrderCancelled>);
+static_assert(std::is_trivial_v<OrderReduced>);
+static_assert(std::is_trivial_v<LevelUpdate>);
+
+namespace detail {
+
+//! Whether a sink wants level updates, i.e. has `on_level_updates`.
+template <typename Sink, typename = void>
+struct wants_level_updates : std::false_type {};
+
+template <typename Sink>
+struct wants_level_updates<
+    Sink, std::void_t<decltype(std::declval<Sink &>().on_level_updates(
+              std::declval<LevelUpdates const &>()))>> : std::true_type {};
+
+}  // namespace detail
+
+/** \brief Event sink ignoring everything.
+ *
+ * The calls are empty and inlined, so a book using it pays nothing for events.
+ *
+ * Level updates are optional: a book only tracks the levels it changes if its
+ * sink also has `void on_level_updates(LevelUpdates const &)`.
+ */
+struct NullSink final {
+    void on_trade(Trade const &) {}
+    void on_order_added(OrderAdded const &) {}
+    void on_order_cancelled(OrderCancelled const &) {}
+    void on_order_reduced(OrderReduced const &) {}
+};
+
+/** \brief Event sink logging every event in a human readable way.
+ *
+ * A sink built with a symbol starts its lines with it, so that the books of
+ * several symbols can share a log (see BookManager).
+ */
+struct LogSink final {
+    LogSink() = default;
+    explicit LogSink(std::string_view symbol);
+
+    void on_trade(Trade const &);
+    void on_order_added(OrderAdded const &);
+    void on_order_cancelled(OrderCancelled const &);
+    void on_order_reduced(OrderReduced const &);
+
+    std::string prefix;  //!< "symbol: ", or empty
+};
+
+}  // namespace ob
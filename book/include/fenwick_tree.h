@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ob {
+
+/** \brief Prefix sums over a fixed number of values, updated in O(log n).
+ *
+ * Also known as a binary indexed tree: entry `i` (from 1) holds the sum of
+ * the `i & -i` values ending at `i`, so both a point update and a prefix sum
+ * touch O(log n) entries, and finding where the prefix sums reach a target
+ * is a single descent from the top.
+ */
+class FenwickTree final {
+   public:
+    explicit FenwickTree(std::size_t size = 0) : tree_(size + 1) {
+        this->top_ = 1;
+        while (this->top_ * 2 <= size) {
+            this->top_ *= 2;
+        }
+    }
+
+    //! Number of values.
+    std::size_t size() const { return this->tree_.size() - 1; }
+
+    //! Add `delta` to the value at `index` (from 0).
+    void add(std::size_t index, std::int64_t delta) {
+        for (auto i = index + 1; i < this->tree_.size(); i += lowest(i)) {
+            this->tree_[i] += delta;
+        }
+    }
+
+    //! Sum of the first `count` values.
+    std::int64_t prefix(std::size_t count) const {
+        std::int64_t sum = 0;
+        for (auto i = count; i > 0; i -= lowest(i)) {
+            sum += this->tree_[i];
+        }
+        return sum;
+    }
+
+    /** \brief Largest `count` such that prefix(count) <= target.
+     *
+     * The values must not be negative. Then, if the result is below size(),
+     * the value at that index is the one taking the sum past the target.
+     */
+    std::size_t last_at_most(std::int64_t target) const {
+        std::size_t count = 0;
+        for (auto step = this->top_; step > 0; step /= 2) {
+            auto const next = count + step;
+            if (next < this->tree_.size() && this->tree_[next] <= target) {
+                count = next;
+                target -= this->tree_[next];
+            }
+        }
+        return count;
+    }
+
+   private:
+    static std::size_t lowest(std::size_t i) { return i & (~i + 1); }
+
+    std::vector<std::int64_t> tree_;  //!< Partial sums, from index 1
+    std::size_t top_;                 //!< Highest power of 2 up to size()
+};
+
+}  // namespace ob
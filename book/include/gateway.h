@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "order_book.h"
+#include "wire.h"
+
+namespace ob {
+
+class Gateway;
+
+namespace detail {
+
+//! Event sink sending the fills of each trade to both clients.
+struct FillSink final {
+    Gateway *gateway = nullptr;
+
+    void on_trade(Trade const &);
+    void on_order_added(OrderAdded const &) {}
+    void on_order_cancelled(OrderCancelled const &) {}
+    void on_order_reduced(OrderReduced const &) {}
+};
+
+//! A client, and what is still to be read from it or written to it.
+struct Connection final {
+    std::uint64_t id;
+    int fd;
+    std::vector<char> input;  //!< Received bytes, [begin, end) unread
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    std::vector<char> output;  //!< Reports of the current round of events
+    std::vector<char> unsent;  //!< Reports the socket did not take yet
+    bool queued = false;       //!< Whether it is in the flush list
+};
+
+}  // namespace detail
+
+/** \brief Order-entry server: one book, many clients, one thread (Linux).
+ *
+ * Sockets are non-blocking and watched by an edge-triggered epoll: on each
+ * event, a connection is read until the socket is empty, and every complete
+ * request is decoded in place from its read buffer and executed at once.
+ * Reports are encoded in the output buffer of their connection, and each
+ * connection written to is flushed once per round of events, with a single
+ * writev of what it could not send earlier and of the new reports.
+ *
+ * Only the client that placed an order may cancel or amend it. Orders stay
+ * in the book when their client disconnects.
+ */
+class Gateway final {
+   public:
+    //! Serve the clients of a listening socket, registered in `epoll` with
+    //! an event data of 0.
+    Gateway(int listener, int epoll) : listener_(listener), epoll_(epoll) {
+        this->book_.sink.gateway = this;
+    }
+
+    //! Close the client connections, not the listener nor epoll.
+    ~Gateway();
+
+    Gateway(Gateway const &) = delete;
+    Gateway &operator=(Gateway const &) = delete;
+
+    /** \brief Handle one round of events, waiting at most `timeout_ms` for
+     *         them (-1 to wait forever).
+     *
+     * \return false if epoll failed.
+     */
+    bool poll(int timeout_ms);
+
+    //! Report a trade to the owners of both orders.
+    void on_trade(Trade const &);
+
+    //! Number of clients connected.
+    std::size_t connection_count() const { return this->connections_.size(); }
+
+    OrderBook<MapBackend, detail::FillSink> const &book() const {
+        return this->book_;
+    }
+
+    //! Log what was done, and the final book.
+    void show_summary() const;
+
+   private:
+    using Connection = detail::Connection;
+
+    //! Clients not reading their reports are dropped past this.
+    static constexpr std::size_t max_unsent = 64 << 20;
+
+    //! epoll data of the listening socket, connections count from 1.
+    static constexpr std::uint64_t listener_id = 0;
+
+    void accept_clients();
+
+    /** \brief Read a connection until the socket is empty, executing
+     *         requests.
+     *
+     * \return false if the client is gone: the connection is destroyed.
+     */
+    bool read_requests(Connection &);
+
+    //! Decode and execute one request.
+    void execute(Connection &, char const *request);
+
+    //! Queue a report for a connection, to be sent at the end of the round.
+    void send(Connection &, wire::Report const &);
+
+    //! Write as much as the socket takes. false if the client is gone.
+    bool flush(Connection &);
+
+    //! Close the socket and destroy the connection.
+    void close(Connection &);
+
+    //! The connection of the client that placed an order, if still there.
+    Connection *owner(OrderId) const;
+
+    int listener_;
+    int epoll_;
+    OrderBook<MapBackend, detail::FillSink> book_;
+
+    std::unordered_map<std::uint64_t, std::unique_ptr<Connection>>
+        connections_;
+    std::uint64_t next_id_ = listener_id + 1;
+    std::vector<Connection *> to_flush_;  //!< Written to in this round
+    std::vector<Connection *> flushing_;  //!< Being flushed, kept for reuse
+
+    //! Connection that placed each resting order
+    std::unordered_map<OrderId, std::uint64_t> owners_;
+    Connection *current_ = nullptr;  //!< Whose request is being executed
+    Quantity incoming_left_ = 0;     //!< Of the order being executed
+
+    std::size_t clients_ = 0;
+    std::size_t requests_ = 0;
+    std::size_t trades_ = 0;
+};
+
+/** \brief Listen on a loopback port, 0 for any free one.
+ *
+ * \return the non-blocking socket, or -1.
+ */
+int listen_on(std::uint16_t port);
+
+}  // namespace ob
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "order.h"
+
+//! Write-ahead journal of the order messages processed by a book
+namespace ob::journal {
+
+/** \brief Layout of a journal file.
+ *
+ * Every integer is little-endian. The file starts with a 16 bytes header:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 8    | magic, "OBJOURNL"                        |
+ * | 8      | 2    | version                                  |
+ * | 10     | 6    | reserved, 0                              |
+ *
+ * followed by 32 bytes entries, numbered from 1 without gaps:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 8    | sequence number                          |
+ * | 8      | 1    | type, same letter as in the CSV files    |
+ * | 9      | 1    | side, 'B' or 'S'                         |
+ * | 10     | 1    | time in force, 0 GTC, 1 IOC, 2 FOK       |
+ * | 11     | 1    | reserved, 0                              |
+ * | 12     | 4    | order ID                                 |
+ * | 16     | 4    | quantity                                 |
+ * | 20     | 4    | price                                    |
+ * | 24     | 4    | reserved, 0                              |
+ * | 28     | 4    | 32-bit FNV-1a hash of the bytes before   |
+ *
+ * An entry cut short by a crash, or with a wrong hash, ends the journal.
+ */
+constexpr char magic[8] = {'O', 'B', 'J', 'O', 'U', 'R', 'N', 'L'};
+constexpr std::uint16_t version = 1;
+constexpr std::size_t header_size = 16;
+constexpr std::size_t entry_size = 32;
+
+//! A decoded entry.
+struct Entry final {
+    std::uint64_t sequence;  //!< Position in the journal, from 1
+    OrderType type;          //!< New order, cancel or amend
+    Order order;             //!< The order message
+};
+
+//! Whether the data starts like a journal.
+bool has_magic(std::string_view data);
+
+/** \brief Read the entries of a journal in place, e.g. from a MappedFile.
+ *
+ * Only the entries before the first invalid one are readable: this is what
+ * survived a crash.
+ */
+class Reader final {
+   public:
+    explicit Reader(std::string_view data);
+
+    //! Why the journal cannot be read at all, or null.
+    char const *error() const { return this->error_; }
+
+    //! Number of valid entries.
+    std::size_t size() const { return this->size_; }
+
+    //! Whether the journal ends with a partial or corrupted entry.
+    bool torn() const { return this->torn_; }
+
+    //! Byte offset of an entry in the file.
+    static std::size_t offset(std::size_t index) {
+        return header_size + index * entry_size;
+    }
+
+    //! Decode a valid entry, `index` < `size()`.
+    Entry read(std::size_t index) const;
+
+   private:
+    char const *entries_ = nullptr;
+    std::size_t size_ = 0;
+    bool torn_ = false;
+    char const *error_ = nullptr;
+};
+
+//! When a Writer makes its entries durable.
+struct WriterConfig final {
+    /** \brief Sync from a flusher thread, for many entries at once.
+     *
+     * Otherwise every append writes and syncs its entry before returning.
+     */
+    bool group_commit = true;
+
+    //! Sync as soon as this many entries are waiting.
+    std::size_t batch_size = 512;
+
+    //! Sync at most this long after the first waiting entry was appended.
+    std::chrono::microseconds max_delay{500};
+};
+
+//! What a Writer did, for monitoring and benchmarks.
+struct WriterStats final {
+    std::uint64_t syncs = 0;    //!< Number of write and sync calls
+    std::uint64_t entries = 0;  //!< Entries made durable
+    //! Longest time between an append and the end of its sync
+    std::uint64_t max_commit_ns = 0;
+    //! Sum, over the syncs, of the wait of the oldest entry of each batch
+    std::uint64_t total_commit_ns = 0;
+};
+
+/** \brief Append entries to a journal file, and make them durable.
+ *
+ * Appending only encodes the entry in memory and gives it the next sequence
+ * number. With group commit, a flusher thread writes and syncs the waiting
+ * entries together, as soon as a batch is full or the oldest entry has
+ * waited long enough. A message must not be acknowledged before its
+ * sequence number is durable.
+ *
+ * An existing journal is continued: its torn end, if any, is cut off, and
+ * numbering goes on from its last valid entry.
+ *
+ * A failed write or sync is final: nothing is written after it, durable()
+ * stops moving, and the entries appended since are dropped.
+ *
+ * Only one thread may append.
+ */
+class Writer final {
+   public:
+    explicit Writer(std::string const &path, WriterConfig const &config = {});
+
+    //! Make every entry durable, then close the file.
+    ~Writer();
+
+    Writer(Writer const &) = delete;
+    Writer &operator=(Writer const &) = delete;
+
+    //! Whether the file could be opened.
+    explicit operator bool() const { return this->fd_ >= 0; }
+
+    //! Journal a message, and return its sequence number.
+    std::uint64_t append(OrderType, Order const &);
+
+    //! Sequence number of the last entry on disk.
+    std::uint64_t durable() const {
+        return this->durable_.load(std::memory_order_acquire);
+    }
+
+    //! Whether a write or sync failed, see durable() for what is on disk.
+    bool failed() const {
+        return this->failed_.load(std::memory_order_acquire);
+    }
+
+    /** \brief Wait until an entry is on disk.
+     *
+     * Returns early if the journal could not be written, see failed().
+     */
+    void wait_durable(std::uint64_t sequence);
+
+    /** \brief Make every entry appended so far durable, without waiting for
+     *         a full batch.
+     *
+     * \return false if the journal could not be written.
+     */
+    bool sync();
+
+    //! Only read once the writer is synced.
+    WriterStats const &stats() const { return this->stats_; }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    //! Write entries to the file and sync it.
+    bool write_and_sync(char const *data, std::size_t size);
+
+    //! Body of the flusher thread.
+    void run();
+
+    WriterConfig config_;
+    int fd_ = -1;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;     //!< For the flusher
+    std::condition_variable flushed_;  //!< For wait_durable
+    std::vector<char> buffer_;         //!< Entries not written yet
+    std::uint64_t appended_ = 0;       //!< Last sequence number given
+    Clock::time_point oldest_;         //!< Append time of buffer's first
+    bool sync_requested_ = false;
+    bool stopping_ = false;
+
+    std::atomic<std::uint64_t> durable_{0};
+    std::atomic<bool> failed_{false};  //!< Never reset
+    WriterStats stats_;  //!< Flusher only
+    std::thread flusher_;
+};
+
+}  // namespace ob::journal
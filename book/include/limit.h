@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <type_traits>
+
+#include "order.h"
+#include "prefix_sum.h"
+
+namespace ob {
+
+/** \brief Position of an order in its limit.
+ *
+ * It does not change while the order rests, unless the limit is compacted
+ * (see Limit::compact).
+ */
+using Slot = std::size_t;
+
+/** \brief Orders resting at a single price, in time priority.
+ *
+ * A FIFO stored as a structure of arrays: the quantities and the IDs of the
+ * orders are kept in two arrays, in priority order, and the side and price
+ * once for the whole limit. Matching only reads the quantities, so a single
+ * prefix sum over them tells how many orders an incoming quantity fills
+ * entirely (see fill_front).
+ *
+ * Every order gets a Slot when it is added, so cancelling it is O(1): its
+ * quantity is set to 0, which the prefix sums step over, and its room is
+ * reclaimed once the front of the queue has moved past it. When cancelled
+ * orders outnumber the live ones, compact() packs the arrays again.
+ *
+ * The arrays come from a memory resource: a limit in a std::pmr container
+ * uses the resource of the container.
+ *
+ * The total quantity of the orders is kept up to date as they are added,
+ * removed and partially filled (see reduce), so reading the depth of a level
+ * does not walk its orders.
+ */
+class Limit final {
+   public:
+    //! Forward iterator over the orders of a limit, which it rebuilds.
+    class Iterator final {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Order;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Order;
+
+        Iterator(Limit const *limit, std::size_t index)
+            : limit_(limit), index_(index) {}
+
+        Order operator*() const {
+            return this->limit_->order_at(this->index_);
+        }
+
+        Iterator &operator++() {
+            this->index_ = this->limit_->next_live(this->index_ + 1);
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(Iterator const &other) const {
+            return this->index_ == other.index_;
+        }
+        bool operator!=(Iterator const &other) const {
+            return this->index_ != other.index_;
+        }
+
+       private:
+        Limit const *limit_;
+        std::size_t index_;  //!< In the arrays of the limit
+    };
+
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using allocator_type = std::pmr::polymorphic_allocator<Quantity>;
+
+    //! Room for orders allocated by the first push_back.
+    static constexpr std::uint32_t initial_capacity = 8;
+
+    //! Cancelled orders worth packing away, see wasteful().
+    static constexpr std::uint32_t min_waste = 64;
+
+    Limit() = default;
+
+    explicit Limit(allocator_type const &allocator) : allocator_(allocator) {}
+
+    //! Handles point to their limit, which must therefore not move.
+    Limit(Limit const &) = delete;
+    Limit &operator=(Limit const &) = delete;
+
+    ~Limit() {
+        if (this->data_ != nullptr) {
+            this->allocator_.deallocate(this->data_, 2 * this->capacity_);
+        }
+    }
+
+    bool empty() const { return this->size_ == 0; }
+    std::size_t size() const { return this->size_; }
+
+    //! Sum of the quantities of the orders.
+    Quantity quantity() const { return this->quantity_; }
+
+    //! Price of the orders, once one was added.
+    Price price() const { return this->price_; }
+
+    //! Number of orders the limit can hold before it allocates.
+    std::size_t capacity() const { return this->capacity_; }
+
+    //! Oldest order. The limit must not be empty.
+    Order front() const { return this->order_at(this->head_); }
+
+    //! Order in a slot. It must still be resting.
+    Order at(Slot slot) const { return this->order_at(slot - this->offset_); }
+
+    //! Append an order at the back of the queue, and return its slot.
+    Slot push_back(Order const &order) {
+        if (this->end_ == this->capacity_) {
+            this->make_room();
+        }
+        this->quantities()[this->end_] = order.quantity;
+        this->ids()[this->end_] = order.id;
+        this->side_ = order.side;
+        this->price_ = order.price;
+        ++this->size_;
+        this->quantity_ += order.quantity;
+        return this->offset_ + this->end_++;
+    }
+
+    /** \brief Lower the quantity of an order, which keeps its place.
+     *
+     * The order must be left with some quantity, see erase otherwise.
+     */
+    void reduce(Slot slot, Quantity by) {
+        this->quantities()[slot - this->offset_] -= by;
+        this->quantity_ -= by;
+    }
+
+    //! Lower the quantity of the oldest order, see reduce.
+    void reduce_front(Quantity by) {
+        this->quantities()[this->head_] -= by;
+        this->quantity_ -= by;
+    }
+
+    //! Remove an order from anywhere in the queue, and return it.
+    Order erase(Slot slot) {
+        auto const index = slot - this->offset_;
+        auto const order = this->order_at(index);
+        this->quantities()[index] = 0;
+        --this->size_;
+        this->quantity_ -= order.quantity;
+        ++this->cancelled_;
+        this->skip_cancelled();
+        return order;
+    }
+
+    //! Remove the oldest order, and return it. The limit must not be empty.
+    Order pop_front() { return this->erase(this->offset_ + this->head_); }
+
+    /** \brief Fill the oldest orders that `quantity` covers entirely.
+     *
+     * Calls `f(id, quantity)` for each of them, in priority order, and
+     * removes them. The order left at the front, if any, holds more than
+     * what remains of `quantity`.
+     *
+     * \return The quantity filled.
+     */
+    template <typename F>
+    Quantity fill_front(Quantity quantity, F &&f) {
+        auto const quantities = this->quantities();
+        auto const ids = this->ids();
+        auto const first = this->head_;
+        auto const last = first + static_cast<std::uint32_t>(
+                                      detail::prefix_within(
+                                          quantities + first,
+                                          this->end_ - first, quantity));
+        Quantity filled = 0;
+        for (auto index = first; index < last; ++index) {
+            auto const resting = quantities[index];
+            if (resting > 0) {
+                f(ids[index], resting);
+                filled += resting;
+                --this->size_;
+            } else {
+                --this->cancelled_;
+            }
+        }
+        this->quantity_ -= filled;
+        this->head_ = last;
+        this->skip_cancelled();
+        return filled;
+    }
+
+    //! Whether cancelled orders take more room than the resting ones.
+    bool wasteful() const {
+        return this->cancelled_ >= min_waste && this->cancelled_ > this->size_;
+    }
+
+    /** \brief Pack the resting orders at the start of the arrays.
+     *
+     * Every order gets a new slot, passed to `f(id, slot)` so that whoever
+     * kept the old one can update it. Slots are never reused.
+     */
+    template <typename F>
+    void compact(F &&f) {
+        auto const quantities = this->quantities();
+        auto const ids = this->ids();
+        std::uint32_t kept = 0;
+        for (auto index = this->head_; index < this->end_; ++index) {
+            if (quantities[index] > 0) {
+                quantities[kept] = quantities[index];
+                ids[kept] = ids[index];
+                ++kept;
+            }
+        }
+        this->offset_ += this->end_;
+        this->head_ = 0;
+        this->end_ = kept;
+        this->cancelled_ = 0;
+
+        for (std::uint32_t index = 0; index < kept; ++index) {
+            f(ids[index], this->offset_ + index);
+        }
+    }
+
+    iterator begin() const { return iterator(this, this->head_); }
+    iterator end() const { return iterator(this, this->end_); }
+
+   private:
+    // Both arrays are cut from a single allocation
+    static_assert(std::is_same_v<OrderId, Quantity>,
+                  "The IDs are stored in an array of quantities");
+
+    Quantity *quantities() const { return this->data_; }
+    OrderId *ids() const { return this->data_ + this->capacity_; }
+
+    Order order_at(std::size_t index) const {
+        return Order{this->ids()[index], this->side_,
+                     this->quantities()[index], this->price_,
+                     TimeInForce::GTC};
+    }
+
+    //! First resting order at or after `index`, or the end of the arrays.
+    std::size_t next_live(std::size_t index) const {
+        while (index < this->end_ && this->quantities()[index] == 0) {
+            ++index;
+        }
+        return index;
+    }
+
+    //! Move the front past cancelled orders, or start over once empty.
+    void skip_cancelled() {
+        if (this->size_ == 0) {
+            this->offset_ += this->end_;
+            this->head_ = this->end_ = this->cancelled_ = 0;
+            return;
+        }
+        while (this->quantities()[this->head_] == 0) {
+            ++this->head_;
+            --this->cancelled_;
+        }
+    }
+
+    /** \brief Make room for one more order at the end of the arrays.
+     *
+     * The orders are moved down over the room freed at the front when that
+     * is more than half of the arrays, otherwise the arrays double. Either
+     * way that is amortized O(1) per order.
+     */
+    void make_room() {
+        auto const kept = this->end_ - this->head_;
+        auto capacity = this->capacity_;
+        auto target = this->data_;
+        if (2 * kept >= capacity) {
+            capacity = std::max(initial_capacity, 2 * capacity);
+            target = this->allocator_.allocate(2 * std::size_t{capacity});
+        }
+        std::copy(this->quantities() + this->head_,
+                  this->quantities() + this->end_, target);
+        std::copy(this->ids() + this->head_, this->ids() + this->end_,
+                  target + capacity);
+        if (target != this->data_ && this->data_ != nullptr) {
+            this->allocator_.deallocate(this->data_, 2 * this->capacity_);
+        }
+        this->data_ = target;
+        this->offset_ += this->head_;
+        this->capacity_ = capacity;
+        this->head_ = 0;
+        this->end_ = kept;
+    }
+
+    allocator_type allocator_;  //!< Of the arrays
+    //! `capacity_` quantities, then as many IDs, in priority order
+    Quantity *data_ = nullptr;
+    Slot offset_ = 0;                  //!< Slot of the first entry
+    std::uint32_t capacity_ = 0;       //!< Entries in each array
+    std::uint32_t head_ = 0;           //!< Index of the oldest resting order
+    std::uint32_t end_ = 0;            //!< Index after the newest order
+    std::uint32_t size_ = 0;           //!< Number of orders in the queue
+    std::uint32_t cancelled_ = 0;      //!< Cancelled entries after the front
+    Quantity quantity_ = 0;            //!< Total quantity of the orders
+    Price price_ = 0;                  //!< Shared by all the orders
+    OrderSide side_ = OrderSide::BUY;  //!< Shared by all the orders
+};
+
+}  // namespace ob
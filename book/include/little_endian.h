@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ob::detail {
+
+//! Read a little-endian integer, whatever the endianness of the host.
+template <typename T>
+T load(char const *data) {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        value |= std::uint64_t{static_cast<unsigned char>(data[i])} << (8 * i);
+    }
+    return static_cast<T>(value);
+}
+
+//! Write a little-endian integer, whatever the endianness of the host.
+template <typename T>
+void store(char *data, T value) {
+    auto const bits = static_cast<std::uint64_t>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        data[i] = static_cast<char>((bits >> (8 * i)) & 0xff);
+    }
+}
+
+}  // namespace ob::detail
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+#include "spdlog/spdlog.h"
+
+/** \brief Log statements of the hot path (matching, events, parsing).
+ *
+ * Building with OB_NO_HOT_PATH_LOGS (the ORDER_BOOK_HOT_PATH_LOGS CMake
+ * option) turns them into nothing: the arguments are only used inside
+ * `sizeof`, so they are still type-checked but never evaluated.
+ */
+#if defined(OB_NO_HOT_PATH_LOGS)
+#define OB_LOG_DEBUG(...) \
+    static_cast<void>(sizeof(spdlog::debug(__VA_ARGS__), 0))
+#define OB_LOG_INFO(...) \
+    static_cast<void>(sizeof(spdlog::info(__VA_ARGS__), 0))
+#define OB_LOG_ERROR(...) \
+    static_cast<void>(sizeof(spdlog::error(__VA_ARGS__), 0))
+#else
+#define OB_LOG_DEBUG(...) spdlog::debug(__VA_ARGS__)
+#define OB_LOG_INFO(...) spdlog::info(__VA_ARGS__)
+#define OB_LOG_ERROR(...) spdlog::error(__VA_ARGS__)
+#endif
+
+namespace ob {
+
+//! Whether the hot path log statements were compiled in.
+#if defined(OB_NO_HOT_PATH_LOGS)
+inline constexpr bool hot_path_logs = false;
+#else
+inline constexpr bool hot_path_logs = true;
+#endif
+
+//! Number of messages the asynchronous logger can hold before dropping some.
+inline constexpr std::size_t async_log_queue_size = 1 << 16;
+
+/** \brief Set up the default logger.
+ *
+ * With OB_ASYNC_LOGS (the ORDER_BOOK_ASYNC_LOGS CMake option), messages are
+ * pushed into a ring buffer and written by a background thread, so logging
+ * never waits for I/O. When the buffer is full, the oldest messages are
+ * dropped rather than blocking the caller. Otherwise nothing changes.
+ */
+void init_logging();
+
+//! Flush pending messages, and stop the background thread if there is one.
+void shutdown_logging();
+
+}  // namespace ob
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ob {
+
+/** \brief Read-only view of a whole file, mapped in memory.
+ *
+ * The contents are read straight from the page cache, without copies. On
+ * platforms without mmap the file is read into a buffer instead.
+ */
+class MappedFile final {
+   public:
+    explicit MappedFile(std::string const &path);
+    ~MappedFile();
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+
+    //! Whether the file could be opened and mapped.
+    explicit operator bool() const { return this->ok_; }
+
+    std::string_view view() const { return {this->data_, this->size_}; }
+
+    /** \brief Tell the system we are done with everything before `offset`.
+     *
+     * The pages can be dropped from memory (they are read again if needed),
+     * so reading a file from start to end only keeps a window of it resident.
+     */
+    void discard(std::size_t offset);
+
+   private:
+    char const *data_ = nullptr;
+    std::size_t size_ = 0;
+    bool ok_ = false;
+#if defined(_WIN32)
+    std::vector<char> buffer_;  //!< The contents, when they are copied
+#endif
+};
+
+}  // namespace ob
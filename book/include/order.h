@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <string>
+#include <type_traits>
+
+//! Declaration & implementation of the order book library
+namespace ob {
+
+/** \brief Define a new type to represent prices.
+ *
+ * Ideally this would be a strong typedef.
+ */
+using Price = int;
+
+/** \brief Define a new type to represent quantities.
+ *
+ * Ideally this would be a strong typedef.
+ */
+using Quantity = int;
+
+/** \brief Define a new type to represent order IDs.
+ *
+ * Ideally this would be a strong typedef.
+ */
+using OrderId = int;
+
+//! Strongly-typed order side.
+enum class OrderSide { BUY, SELL };
+
+//! Strongly-typed order type.
+enum class OrderType { NEW, CANCEL, MODIFY };
+
+/** \brief For larger enums, x-macros would be useful.
+ *
+ * The comparator is transparent so that parsers can look up a string_view
+ * without building a string.
+ */
+static const std::map<std::string, OrderType, std::less<>> StringToOrderType{
+    {"A", OrderType::NEW},
+    {"X", OrderType::CANCEL},
+    {"M", OrderType::MODIFY}};
+
+//! Letter of an order type, the reverse of StringToOrderType.
+constexpr char OrderTypeToChar(OrderType type) {
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (type) {
+        case OrderType::NEW:
+            return 'A';
+        case OrderType::CANCEL:
+            return 'X';
+        case OrderType::MODIFY:
+            return 'M';
+    }
+    return '?';
+}
+
+//! What happens to the part of an order that cannot be matched right away.
+enum class TimeInForce : std::uint8_t {
+    GTC,  //!< Good till cancelled: it rests in the book
+    IOC,  //!< Immediate or cancel: it is dropped
+    FOK,  //!< Fill or kill: the order only executes if it fills entirely
+};
+
+//! Time in force names, as found in the CSV files.
+static const std::map<std::string, TimeInForce, std::less<>>
+    StringToTimeInForce{{"GTC", TimeInForce::GTC},
+                        {"IOC", TimeInForce::IOC},
+                        {"FOK", TimeInForce::FOK}};
+
+namespace detail {
+
+//! Whether a byte of a binary file or journal encodes a time in force.
+constexpr bool valid_time_in_force(char byte) {
+    return byte >= static_cast<char>(TimeInForce::GTC) &&
+           byte <= static_cast<char>(TimeInForce::FOK);
+}
+
+}  // namespace detail
+
+/** \brief Price of a market order: a buy crosses every ask, a sell every bid.
+ *
+ * Market orders cannot rest in the book, so they must be IOC or FOK.
+ */
+constexpr Price market_price(OrderSide side) {
+    return side == OrderSide::BUY ? std::numeric_limits<Price>::max()
+                                  : std::numeric_limits<Price>::min();
+}
+
+/** \brief POD order representation
+ *
+ * The time in force comes last so that `Order{id, side, quantity, price}`
+ * still builds a GTC limit order.
+ */
+struct Order final {
+    OrderId id;                 //!< Unique ID
+    OrderSide side;             //!< Buy/Sell
+    Quantity quantity;          //!< Remaining quantity
+    Price price;                //!< Price, or market_price(side)
+    TimeInForce time_in_force;  //!< GTC for every resting order
+};
+
+/**
+ * This is a bit overkill in such a simple case but I like to make assertions
+ * about the properties of my structures, especially when they are generated by
+ * the compiler
+ */
+static_assert(std::is_trivial_v<Order>);
+static_assert(static_cast<int>(TimeInForce::GTC) == 0,
+              "Value-initialized orders are GTC");
+static_assert(std::is_default_constructible_v<Order>);
+static_assert(std::is_copy_constructible_v<Order>);
+static_assert(std::is_move_constructible_v<Order>);
+
+//! Enable use of ASSERT_EQ on Order objects in the test suite.
+inline bool operator==(Order const &left, Order const &right) {
+    return left.id == right.id && left.side == right.side &&
+           left.quantity == right.quantity && left.price == right.price &&
+           left.time_in_force == right.time_in_force;
+}
+
+}  // namespace ob
@@ -1,79 +1,91 @@
 #pragma once
 
-#include <fstream>
-#include <map>
-#include <string>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "auction.h"
+#include "book_stats.h"
+#include "events.h"
+#include "limit.h"
+#include "logging.h"
+#include "order.h"
+#include "price_ladder.h"
+#include "snapshot.h"
 #include "spdlog/spdlog.h"
 
-//! Declaration & implementation of the order book library
 namespace ob {
 
-/** \brief Define a new type to represent prices.
- *
- * Ideally this would be a strong typedef.
- */
-using Price = int;
+//! Where a resting order lives, so it can be reached from its ID alone.
+struct OrderHandle final {
+    OrderSide side;  //!< Table the order rests in
+    Limit *limit;    //!< Limit holding the order (never moves)
+    Slot slot;       //!< Position of the order inside its limit
+};
 
-/** \brief Define a new type to represent quantities.
+/** \brief Bid and ask tables, and functions to add/cancel orders.
+ *
+ * The backend decides how price levels are stored (see MapBackend and
+ * FlatBackend). The map backend is the reference implementation.
+ *
+ * Fills, new resting orders and cancels are reported to the sink (see
+ * events.h). The sink is a template parameter so that the default NullSink
+ * costs nothing.
+ *
+ * The limits, their orders and the index take their memory from a pool of
+ * the book, on top of the resource given to the constructor. Each limit
+ * keeps its capacity as orders come and go, and the map backend reuses
+ * emptied limits for new prices, so a warm book does not allocate while
+ * matching.
  *
- * Ideally this would be a strong typedef.
+ * If the sink wants level updates, the levels changed by each order or
+ * cancel are sent to it in one batch once the book is done with it.
+ *
+ * With BookStats instead of the default NullStats, the latency of each
+ * place_order and cancel is recorded, along with how much matching they did.
  */
-using Quantity = int;
-
-//! Strongly-typed order side.
-enum class OrderSide { BUY, SELL };
+template <typename Backend = MapBackend, typename Sink = NullSink,
+          typename Stats = NullStats>
+struct OrderBook final {
+    //! Recycles the memory of the limits and of the index entries
+    std::pmr::unsynchronized_pool_resource memory;
 
-//! Strongly-typed order type.
-enum class OrderType { NEW, CANCEL };
+    typename Backend::Bids bids;  //! Table of bids
+    typename Backend::Asks asks;  //! Table of asks
 
-//! For larger enums, x-macros would be useful.
-static const std::map<std::string, OrderType> StringToOrderType{
-    {"A", OrderType::NEW}, {"X", OrderType::CANCEL}};
+    //! Receives the events of the book
+    Sink sink;
 
-//! POD order representation
-struct Order final {
-    int id;             //!< Unique ID
-    OrderSide side;     //!< Buy/Sell
-    Quantity quantity;  //!< Remaining quantity
-    Price price;        //!< Price
-};
+    //! Latencies and counters, when enabled (see book_stats.h)
+    Stats stats;
 
-/**
- * This is a bit overkill in such a simple case but I like to make assertions
- * about the properties of my structures, especially when they are generated by
- * the compiler
- */
-static_assert(std::is_trivial_v<Order>);
-static_assert(std::is_default_constructible_v<Order>);
-static_assert(std::is_copy_constructible_v<Order>);
-static_assert(std::is_move_constructible_v<Order>);
+    //! Every resting order, by ID. Kept in sync with the bid and ask tables.
+    std::pmr::unordered_map<OrderId, OrderHandle> order_index{&this->memory};
 
-//! Enable use of ASSERT_EQ on Order objects in the test suite.
-inline bool operator==(Order const &left, Order const &right) {
-    return left.id == right.id && left.side == right.side &&
-           left.quantity == right.quantity && left.price == right.price;
-}
+    OrderBook() : OrderBook(LadderConfig{}) {}
 
-/** \brief Using std:map with default ordering, to hit the smallest asks first
- *         when we place a bid.
- *
- * We could easily reserve a few limits to reduce the number of allocations.
- */
-using Asks = std::map<Price, std::vector<Order>>;
+    //! Build a book getting its memory from `upstream`, e.g. an arena.
+    explicit OrderBook(std::pmr::memory_resource *upstream)
+        : OrderBook(LadderConfig{}, Sink(), upstream) {}
 
-/** \brief Using std:map with default ordering, to hit the largest bids first
- *         when we place an ask.
- *
- * We could easily reserve a few limits to reduce the number of allocations.
- */
-using Bids = std::map<Price, std::vector<Order>, std::greater<Price>>;
+    //! Build a book covering a given price range (for bounded backends).
+    explicit OrderBook(
+        LadderConfig const &config, Sink sink = Sink(),
+        std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+        : memory(upstream),
+          bids(config, &this->memory),
+          asks(config, &this->memory),
+          sink(std::move(sink)) {}
 
-//! Bid and ask tables, and functions to add/cancel orders.
-struct OrderBook final {
-    Bids bids;  //! Table of bids
-    Asks asks;  //! Table of asks
+    //! Preallocate the index for a given number of resting orders.
+    void reserve(std::size_t orders);
 
     //! Log the current bids table
     void show_bids(
@@ -84,30 +96,940 @@ struct OrderBook final {
         spdlog::level::level_enum log_level = spdlog::level::debug) const;
 
     //! Execute an order as much as possible at a given limit.
-    auto execute_at_limit(std::vector<Order> &, Order &);
+    auto execute_at_limit(Limit &, Order &);
 
     /** \brief Try to add a bid order.
      *
      * Try to execute the order as much as possible, then place the remaining
-     * order in the bid table.
+     * order in the bid table. An IOC order drops what it could not execute.
+     * A FOK order is only executed if the asks can fill it entirely, which
+     * is checked from the level totals before anything changes.
+     *
+     * The order's quantity is left to what was not executed.
+     *
+     * \return false if an order with the same ID is already in the book, or
+     *         if a GTC order is a market order or has a price the backend
+     *         cannot store.
      */
-    void bid(Order &);
+    bool bid(Order &);
 
     /** \brief Try to add a ask order.
      *
      * Try to execute the order as much as possible, then places the remaining
-     * order in the ask table.
+     * order in the ask table. IOC and FOK orders are handled like in bid.
+     *
+     * \return false if an order with the same ID is already in the book, or
+     *         if a GTC order is a market order or has a price the backend
+     *         cannot store.
+     */
+    bool ask(Order &);
+
+    /** \brief Remove an order if it is still in the book, using its ID.
+     *
+     * Only the ID is needed: the side and price are found through the order
+     * index, in constant time.
+     *
+     * \return true if an order was removed.
      */
-    void ask(Order &);
+    bool cancel(OrderId);
 
-    //! Remove an order if it is still in the book, using its ID.
-    void cancel(Order const &);
+    //! Same as cancel(OrderId), for callers holding a full cancel message.
+    bool cancel(Order const &);
 
     //! Call bid or ask depending on the order's side.
-    void place_order(Order &);
-};  // namespace ob
+    bool place_order(Order &);
+
+    /** \brief Place `count` orders, in order, as if by place_order.
+     *
+     * Memory for the new resting orders is reserved once, the limits of the
+     * next orders are prefetched while the current one is matched (with the
+     * flat backend), and the level updates of the whole batch are sent to
+     * the sink at once. The batch is not measured by the stats.
+     *
+     * \return the number of orders accepted.
+     */
+    std::size_t submit_batch(Order *orders, std::size_t count);
+
+    /** \brief Start a call auction.
+     *
+     * Until uncross is called, orders rest without being matched, so the
+     * book may cross. Only GTC orders are accepted. Cancels and amends work
+     * as usual, without matching either.
+     */
+    void open_auction() { this->auction_ = true; }
+
+    //! Whether orders are collected for a call auction.
+    bool in_auction() const { return this->auction_; }
+
+    /** \brief End the call auction, executing every crossed order at a
+     *         single equilibrium price (see detail::equilibrium).
+     *
+     * Orders are executed in price then time priority on both sides. In the
+     * trades, the bid is reported as the incoming order, and each side's
+     * partially filled order as reduced. Continuous matching resumes
+     * afterwards.
+     */
+    AuctionResult uncross();
+
+    /** \brief Change the quantity or price of a resting order, using its ID.
+     *
+     * A lower quantity at the same price is updated in place, and the order
+     * keeps its priority. A new price or a higher quantity puts the order at
+     * the back of the queue of its (new) price, after matching it like a new
+     * order: the sink sees it cancelled then added, and the level updates of
+     * the whole amend are sent at once. The order stays GTC.
+     *
+     * \return false if the order is not in the book, or if the amend changes
+     *         its side, has no quantity, or has a price the backend cannot
+     *         store. The book is unchanged in that case.
+     */
+    bool amend(Order &);
+
+    //! Total quantity resting at a price, 0 if there is no such level.
+    Quantity quantity_at(OrderSide, Price) const;
+
+    /** \brief Total quantity resting on one side at `limit` or better.
+     *
+     * O(log n) with the flat backend, which keeps its level totals in a
+     * Fenwick tree. The map backend sums the totals of the levels up to the
+     * limit.
+     */
+    std::int64_t quantity_until(OrderSide, Price limit) const;
+
+    /** \brief Worst price reached, and total cost, when taking `quantity`
+     *         from one side, best price first.
+     *
+     * O(log n) with the flat backend, a walk over the levels with the map
+     * backend. Nothing is changed in the book.
+     *
+     * \return false if the side holds less than `quantity`.
+     */
+    bool estimate_fill(OrderSide, std::int64_t quantity,
+                       FillEstimate &) const;
+
+    /** \brief Copy the `n` best levels of one side to `out`, best first.
+     *
+     * Levels keep their totals up to date, so this is O(n) whatever the
+     * number of orders, and nothing is allocated.
+     *
+     * \return the number of levels written, at most `n`.
+     */
+    std::size_t depth(OrderSide, DepthLevel *out, std::size_t n) const;
+
+    /** \brief Sequence number of the last level update, 0 if none.
+     *
+     * A copy of the levels (see depth) taken along with this number is a
+     * snapshot: applying the following updates keeps it in sync.
+     */
+    std::uint64_t sequence() const { return this->sequence_; }
+
+    /** \brief Write every resting order to a stream (see snapshot.h).
+     *
+     * Levels are written best price first, and orders in time priority, so
+     * loading the snapshot gives back the same book. `journal` is the last
+     * journal entry applied to the book, if its messages are journaled.
+     */
+    void save_snapshot(std::ostream &, std::uint64_t journal = 0) const;
+
+    /** \brief Restore the orders of a snapshot, in an empty book.
+     *
+     * The levels are built directly, without matching and without sending
+     * events. The whole snapshot is checked first: if it is corrupted, or if
+     * the book cannot hold one of its prices, the book is left empty.
+     *
+     * \return false if the snapshot was not loaded.
+     */
+    bool load_snapshot(std::string_view data);
+
+   private:
+    //! place_order, without measuring it.
+    bool route_order(Order &);
+
+    //! cancel(OrderId), without measuring it.
+    bool cancel_order(OrderId);
+
+    //! amend, without measuring it.
+    bool amend_order(Order &);
+
+    //! Execute the front orders of two crossed limits at a given price.
+    void cross_limits(Limit &bids, Limit &asks, Price);
+
+    /** \brief Remove the front order of a limit if it is filled, or report
+     *         it. `order` is the front order, before the fill.
+     */
+    void settle_front(Limit &, Order order, Quantity filled);
+
+    //! Match a bid against the asks, then rest what is left of it.
+    void execute_bid(Order &);
+
+    //! Match an ask against the bids, then rest what is left of it.
+    void execute_ask(Order &);
+
+    //! Count a level traded at by an incoming order, if stats are enabled.
+    void count_swept();
+
+    //! Count a resting order fully executed, if stats are enabled.
+    void count_filled();
+
+    //! Reject orders the book cannot accept, before touching any table.
+    template <typename Table>
+    bool validate(Table const &, Order const &, char const *name) const;
+
+    //! Append an order to its limit and record where it was put.
+    template <typename Table>
+    void rest_order(Table &, Order const &);
+
+    //! Erase an order from its limit, using the handle from the index.
+    template <typename Table>
+    void erase_order(Table &, OrderHandle const &);
+
+    //! Pack a limit with many cancelled orders, and update their handles.
+    void compact(Limit &);
+
+    //! Write the levels of one side of the book to a snapshot.
+    template <typename Table>
+    static void save_side(snapshot::Writer &, Table const &);
+
+    //! Whether every level and order of a snapshot can be loaded.
+    bool check_snapshot(snapshot::Reader) const;
+
+    //! Append the orders of a snapshot level to its limit.
+    template <typename Table>
+    void load_level(Table &, snapshot::Level const &);
+
+    /** \brief Remember the new total of a level, for the ladder's index of
+     *         level totals and the sink's level updates.
+     */
+    void record_level(OrderSide, Price, Limit const &);
+
+    //! Send the level updates of the current order or cancel to the sink.
+    void publish_levels();
+
+    //! Orders of a batch looked ahead of the one being matched
+    static constexpr std::size_t prefetch_distance = 8;
+
+    std::uint64_t sequence_ = 0;        //!< Of the last level update
+    std::vector<LevelUpdate> updates_;  //!< Not yet sent to the sink
+    bool auction_ = false;              //!< Collecting a call auction
+};
+
+//! Implementation details of the order book templates
+namespace detail {
+
+/** \brief Print a table (templated to support every backend)
+ *
+ * Example output:
+ * [2020-05-17 17:15:05.526] [info] ===== Bids =====
+ * [2020-05-17 17:15:05.526] [info]   1050:
+ * [2020-05-17 17:15:05.526] [info]   1000:
+ * [2020-05-17 17:15:05.526] [info]     9 #100001
+ * [2020-05-17 17:15:05.543] [info]     1 #100006
+ * [2020-05-17 17:15:05.543] [info]   975:
+ * [2020-05-17 17:15:05.543] [info]     30 #100002
+ * [2020-05-17 17:15:05.543] [info] ===== Asks =====
+ * [2020-05-17 17:15:05.543] [info]   1025:
+ * [2020-05-17 17:15:05.543] [info]     4 #100007
+ * [2020-05-17 17:15:05.543] [info]   1050:
+ * [2020-05-17 17:15:05.543] [info]     10 #100003
+ * [2020-05-17 17:15:05.543] [info]   1075:
+ * [2020-05-17 17:15:05.543] [info]     1 #100000
+ */
+template <typename T>
+void show_table(T const &table, spdlog::level::level_enum log_level) {
+    table.for_each_limit([log_level](Price price, Limit const &limit) {
+        spdlog::log(log_level, "  {}: ", price);
+        for (auto const &order : limit) {
+            spdlog::log(log_level, "    {} #{}", order.quantity, order.id);
+        }
+    });
+}
+
+}  // namespace detail
+
+/**
+ * Library implementation
+ */
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::show_bids(
+    spdlog::level::level_enum log_level) const {
+    if (this->bids.empty()) {
+        spdlog::log(log_level, "No bids");
+        return;
+    }
+
+    spdlog::log(log_level, "===== Bids =====");
+    detail::show_table(this->bids, log_level);
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::show_asks(
+    spdlog::level::level_enum log_level) const {
+    if (this->asks.empty()) {
+        spdlog::log(log_level, "No asks");
+        return;
+    }
+
+    spdlog::log(log_level, "===== Asks =====");
+    detail::show_table(this->asks, log_level);
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::reserve(std::size_t orders) {
+    this->order_index.reserve(orders);
+}
+
+template <typename Backend, typename Sink, typename Stats>
+auto OrderBook<Backend, Sink, Stats>::execute_at_limit(Limit &limit_orders,
+                                                       Order &order) {
+    // Full executions, without leftover quantity in the book: every order
+    // the incoming quantity covers is found in one pass
+    order.quantity -= limit_orders.fill_front(
+        order.quantity, [this, &order, &limit_orders](OrderId id,
+                                                      Quantity quantity) {
+            this->sink.on_trade(Trade{order.id, id, order.side,
+                                      limit_orders.price(), quantity, 0});
+            this->order_index.erase(id);
+            this->count_filled();
+        });
+
+    // Full execution, leftover quantity in the book
+    if (order.quantity > 0 && !limit_orders.empty()) {
+        auto potential_match = limit_orders.front();
+        potential_match.quantity -= order.quantity;
+        limit_orders.reduce_front(order.quantity);
+        this->sink.on_trade(Trade{order.id, potential_match.id, order.side,
+                                  potential_match.price, order.quantity,
+                                  potential_match.quantity});
+        this->sink.on_order_reduced(
+            OrderReduced{potential_match, order.quantity});
+        order.quantity = 0;
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+template <typename Table>
+bool OrderBook<Backend, Sink, Stats>::validate(Table const &table,
+                                               Order const &order,
+                                               char const *name) const {
+    if (this->order_index.count(order.id)) {
+        OB_LOG_ERROR("{} id={} rejected: duplicate order ID", name, order.id);
+        return false;
+    }
+
+    // Only GTC orders can rest, the price of the others is just a limit
+    if (order.time_in_force != TimeInForce::GTC) {
+        if (this->auction_) {
+            OB_LOG_ERROR("{} id={} rejected: only GTC orders during an "
+                         "auction",
+                         name, order.id);
+            return false;
+        }
+        return true;
+    }
+    if (order.price == market_price(order.side)) {
+        OB_LOG_ERROR("{} id={} rejected: market orders must be IOC or FOK",
+                     name, order.id);
+        return false;
+    }
+    if (!table.accepts(order.price)) {
+        OB_LOG_ERROR("{} id={} rejected: price={} is outside the book", name,
+                     order.id, order.price);
+        return false;
+    }
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+template <typename Table>
+void OrderBook<Backend, Sink, Stats>::rest_order(Table &table,
+                                                 Order const &order) {
+    this->sink.on_order_added(OrderAdded{order});
+    auto &limit = table.limit(order.price);
+    auto const slot = limit.push_back(order);
+    this->order_index.emplace(order.id, OrderHandle{order.side, &limit, slot});
+    this->record_level(order.side, order.price, limit);
+}
+
+template <typename Backend, typename Sink, typename Stats>
+template <typename Table>
+void OrderBook<Backend, Sink, Stats>::erase_order(Table &table,
+                                                  OrderHandle const &handle) {
+    auto const order = handle.limit->erase(handle.slot);
+    this->sink.on_order_cancelled(OrderCancelled{order});
+    this->record_level(handle.side, order.price, *handle.limit);
+
+    // The limit itself is only looked up again when it becomes empty
+    if (handle.limit->empty()) {
+        table.erase_limit(order.price);
+    } else if (handle.limit->wasteful()) {
+        this->compact(*handle.limit);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::compact(Limit &limit) {
+    limit.compact([this](OrderId id, Slot slot) {
+        this->order_index.find(id)->second.slot = slot;
+    });
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::record_level(OrderSide side,
+                                                   Price price,
+                                                   Limit const &limit) {
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (side) {
+        case OrderSide::BUY:
+            this->bids.level_changed(price, limit);
+            break;
+        case OrderSide::SELL:
+            this->asks.level_changed(price, limit);
+            break;
+    }
+
+    if constexpr (detail::wants_level_updates<Sink>::value) {
+        // A level changed twice in a row (e.g. emptied then refilled) is only
+        // sent once, with its final quantity
+        if (!this->updates_.empty() && this->updates_.back().side == side &&
+            this->updates_.back().price == price) {
+            this->updates_.back().quantity = limit.quantity();
+            return;
+        }
+        this->updates_.push_back(
+            LevelUpdate{++this->sequence_, side, price, limit.quantity()});
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::publish_levels() {
+    if constexpr (detail::wants_level_updates<Sink>::value) {
+        if (this->updates_.empty()) {
+            return;
+        }
+        this->sink.on_level_updates(
+            LevelUpdates{this->updates_.data(),
+                         this->updates_.data() + this->updates_.size()});
+        this->updates_.clear();
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::count_swept() {
+    if constexpr (Stats::enabled) {
+        ++this->stats.levels_swept;
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::count_filled() {
+    if constexpr (Stats::enabled) {
+        ++this->stats.orders_filled;
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::bid(Order &order) {
+    if (!this->validate(this->bids, order, "Bid")) {
+        return false;
+    }
+    this->execute_bid(order);
+    this->publish_levels();
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::execute_bid(Order &order) {
+    if (this->auction_) {
+        this->rest_order(this->bids, order);
+        return;
+    }
+    if (order.time_in_force == TimeInForce::FOK &&
+        !this->asks.covers(order.price, order.quantity)) {
+        OB_LOG_DEBUG("Bid id={} killed: it cannot be filled", order.id);
+        return;
+    }
+
+    // Only the best limit can match, and it is removed once emptied
+    while (order.quantity > 0 && !this->asks.empty() &&
+           this->asks.best_price() <= order.price) {
+        auto const price = this->asks.best_price();
+        auto &limit = this->asks.best();
+        this->execute_at_limit(limit, order);
+        this->count_swept();
+        this->record_level(OrderSide::SELL, price, limit);
+        if (limit.empty()) {
+            this->asks.pop_best();
+        }
+    }
+
+    if (order.quantity > 0 && order.time_in_force == TimeInForce::GTC) {
+        this->rest_order(this->bids, order);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::ask(Order &order) {
+    if (!this->validate(this->asks, order, "Ask")) {
+        return false;
+    }
+    this->execute_ask(order);
+    this->publish_levels();
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::execute_ask(Order &order) {
+    if (this->auction_) {
+        this->rest_order(this->asks, order);
+        return;
+    }
+    if (order.time_in_force == TimeInForce::FOK &&
+        !this->bids.covers(order.price, order.quantity)) {
+        OB_LOG_DEBUG("Ask id={} killed: it cannot be filled", order.id);
+        return;
+    }
+
+    // Only the best limit can match, and it is removed once emptied
+    while (order.quantity > 0 && !this->bids.empty() &&
+           this->bids.best_price() >= order.price) {
+        auto const price = this->bids.best_price();
+        auto &limit = this->bids.best();
+        this->execute_at_limit(limit, order);
+        this->count_swept();
+        this->record_level(OrderSide::BUY, price, limit);
+        if (limit.empty()) {
+            this->bids.pop_best();
+        }
+    }
+
+    if (order.quantity > 0 && order.time_in_force == TimeInForce::GTC) {
+        this->rest_order(this->asks, order);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::place_order(Order &order) {
+    if constexpr (Stats::enabled) {
+        auto const start = Stats::Clock::now();
+        auto const placed = this->route_order(order);
+        this->stats.place.record(Stats::since(start));
+        return placed;
+    } else {
+        return this->route_order(order);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::route_order(Order &order) {
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (order.side) {
+        case OrderSide::BUY:
+            return this->bid(order);
+        case OrderSide::SELL:
+            return this->ask(order);
+    }
+    return false;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+std::size_t OrderBook<Backend, Sink, Stats>::submit_batch(Order *orders,
+                                                          std::size_t count) {
+    this->reserve(this->order_index.size() + count);
+
+    std::size_t accepted = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i + prefetch_distance < count) {
+            auto const &next = orders[i + prefetch_distance];
+            if (next.side == OrderSide::BUY) {
+                this->bids.prefetch(next.price);
+            } else {
+                this->asks.prefetch(next.price);
+            }
+        }
+
+        auto &order = orders[i];
+        // Since we use an enum, we would get a warning if our switch wasn't
+        // exhaustive
+        switch (order.side) {
+            case OrderSide::BUY:
+                if (!this->validate(this->bids, order, "Bid")) {
+                    continue;
+                }
+                this->execute_bid(order);
+                break;
+            case OrderSide::SELL:
+                if (!this->validate(this->asks, order, "Ask")) {
+                    continue;
+                }
+                this->execute_ask(order);
+                break;
+        }
+        ++accepted;
+    }
+
+    this->publish_levels();
+    return accepted;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+AuctionResult OrderBook<Backend, Sink, Stats>::uncross() {
+    this->auction_ = false;
+    if (this->bids.empty() || this->asks.empty() ||
+        this->bids.best_price() < this->asks.best_price()) {
+        return AuctionResult{0, 0, 0};
+    }
+
+    // Only the crossed levels can execute
+    std::vector<DepthLevel> bid_levels;
+    std::vector<DepthLevel> ask_levels;
+    auto collect = [](std::vector<DepthLevel> &levels) {
+        return [&levels](Price price, Limit const &limit) {
+            levels.push_back(
+                DepthLevel{price, limit.quantity(), limit.size()});
+        };
+    };
+    this->bids.for_each_limit_until(this->asks.best_price(),
+                                    collect(bid_levels));
+    this->asks.for_each_limit_until(this->bids.best_price(),
+                                    collect(ask_levels));
+    auto const result = detail::equilibrium(bid_levels, ask_levels);
+
+    // A level is recorded once, when it is emptied or when the auction is
+    // done with it
+    auto bid_touched = false;
+    auto ask_touched = false;
+    while (!this->bids.empty() && !this->asks.empty() &&
+           this->bids.best_price() >= result.price &&
+           this->asks.best_price() <= result.price) {
+        auto const bid_price = this->bids.best_price();
+        auto const ask_price = this->asks.best_price();
+        auto &bid_limit = this->bids.best();
+        auto &ask_limit = this->asks.best();
+        this->cross_limits(bid_limit, ask_limit, result.price);
+        bid_touched = ask_touched = true;
+
+        if (bid_limit.empty()) {
+            this->record_level(OrderSide::BUY, bid_price, bid_limit);
+            this->bids.pop_best();
+            bid_touched = false;
+        }
+        if (ask_limit.empty()) {
+            this->record_level(OrderSide::SELL, ask_price, ask_limit);
+            this->asks.pop_best();
+            ask_touched = false;
+        }
+    }
+    if (bid_touched) {
+        this->record_level(OrderSide::BUY, this->bids.best_price(),
+                           this->bids.best());
+    }
+    if (ask_touched) {
+        this->record_level(OrderSide::SELL, this->asks.best_price(),
+                           this->asks.best());
+    }
+
+    this->publish_levels();
+    return result;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::cross_limits(Limit &bid_limit,
+                                                   Limit &ask_limit,
+                                                   Price price) {
+    while (!bid_limit.empty() && !ask_limit.empty()) {
+        auto const bid = bid_limit.front();
+        auto const ask = ask_limit.front();
+        auto const quantity = std::min(bid.quantity, ask.quantity);
+        this->sink.on_trade(Trade{bid.id, ask.id, OrderSide::BUY, price,
+                                  quantity, ask.quantity - quantity});
+        this->settle_front(bid_limit, bid, quantity);
+        this->settle_front(ask_limit, ask, quantity);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::settle_front(Limit &limit, Order order,
+                                                   Quantity filled) {
+    if (order.quantity > filled) {
+        limit.reduce_front(filled);
+        order.quantity -= filled;
+        this->sink.on_order_reduced(OrderReduced{order, filled});
+        return;
+    }
+    this->order_index.erase(order.id);
+    limit.pop_front();
+    this->count_filled();
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::cancel(OrderId id) {
+    if constexpr (Stats::enabled) {
+        auto const start = Stats::Clock::now();
+        auto const cancelled = this->cancel_order(id);
+        this->stats.cancel.record(Stats::since(start));
+        return cancelled;
+    } else {
+        return this->cancel_order(id);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::cancel_order(OrderId id) {
+    OB_LOG_DEBUG("Trying to cancel id={}", id);
+    auto found = this->order_index.find(id);
+    if (found == std::end(this->order_index)) {
+        OB_LOG_DEBUG("Cancel: id={} not found", id);
+        return false;
+    }
+
+    auto const handle = found->second;
+    this->order_index.erase(found);
+
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (handle.side) {
+        case OrderSide::BUY:
+            this->erase_order(this->bids, handle);
+            break;
+        case OrderSide::SELL:
+            this->erase_order(this->asks, handle);
+            break;
+    }
+    this->publish_levels();
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::cancel(Order const &order) {
+    return this->cancel(order.id);
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::amend(Order &order) {
+    if constexpr (Stats::enabled) {
+        auto const start = Stats::Clock::now();
+        auto const amended = this->amend_order(order);
+        this->stats.amend.record(Stats::since(start));
+        return amended;
+    } else {
+        return this->amend_order(order);
+    }
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::amend_order(Order &order) {
+    OB_LOG_DEBUG("Trying to amend id={}", order.id);
+    auto found = this->order_index.find(order.id);
+    if (found == std::end(this->order_index)) {
+        OB_LOG_DEBUG("Amend: id={} not found", order.id);
+        return false;
+    }
+
+    // The order keeps resting, whatever the time in force of the message
+    order.time_in_force = TimeInForce::GTC;
+
+    auto const handle = found->second;
+    auto resting = handle.limit->at(handle.slot);
+    if (order.side != resting.side || order.quantity <= 0) {
+        OB_LOG_ERROR("Amend id={} rejected: invalid side or quantity",
+                     order.id);
+        return false;
+    }
 
-//! Deserialize text into Order objects
-std::vector<std::pair<OrderType, Order>> read_orders_file(std::ifstream &);
+    // Same price and no more quantity: the order keeps its place
+    if (order.price == resting.price && order.quantity <= resting.quantity) {
+        auto const reduced_by = resting.quantity - order.quantity;
+        if (reduced_by > 0) {
+            resting.quantity = order.quantity;
+            handle.limit->reduce(handle.slot, reduced_by);
+            this->sink.on_order_reduced(OrderReduced{resting, reduced_by});
+            this->record_level(handle.side, resting.price, *handle.limit);
+            this->publish_levels();
+        }
+        return true;
+    }
+
+    auto const accepted = handle.side == OrderSide::BUY
+                              ? this->bids.accepts(order.price)
+                              : this->asks.accepts(order.price);
+    if (!accepted || order.price == market_price(order.side)) {
+        OB_LOG_ERROR("Amend id={} rejected: price={} is outside the book",
+                     order.id, order.price);
+        return false;
+    }
+
+    // Otherwise the order loses its priority, and may now cross the spread
+    this->order_index.erase(found);
+
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (handle.side) {
+        case OrderSide::BUY:
+            this->erase_order(this->bids, handle);
+            this->execute_bid(order);
+            break;
+        case OrderSide::SELL:
+            this->erase_order(this->asks, handle);
+            this->execute_ask(order);
+            break;
+    }
+    this->publish_levels();
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+Quantity OrderBook<Backend, Sink, Stats>::quantity_at(OrderSide side,
+                                                      Price price) const {
+    Limit const *limit = nullptr;
+    switch (side) {
+        case OrderSide::BUY:
+            limit = this->bids.find_limit(price);
+            break;
+        case OrderSide::SELL:
+            limit = this->asks.find_limit(price);
+            break;
+    }
+    return limit == nullptr ? 0 : limit->quantity();
+}
+
+template <typename Backend, typename Sink, typename Stats>
+std::int64_t OrderBook<Backend, Sink, Stats>::quantity_until(
+    OrderSide side, Price limit) const {
+    switch (side) {
+        case OrderSide::BUY:
+            return this->bids.quantity_until(limit);
+        case OrderSide::SELL:
+            return this->asks.quantity_until(limit);
+    }
+    return 0;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::estimate_fill(
+    OrderSide side, std::int64_t quantity, FillEstimate &fill) const {
+    switch (side) {
+        case OrderSide::BUY:
+            return this->bids.estimate_fill(quantity, fill);
+        case OrderSide::SELL:
+            return this->asks.estimate_fill(quantity, fill);
+    }
+    return false;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+std::size_t OrderBook<Backend, Sink, Stats>::depth(OrderSide side,
+                                                   DepthLevel *out,
+                                                   std::size_t n) const {
+    switch (side) {
+        case OrderSide::BUY:
+            return this->bids.depth(out, n);
+        case OrderSide::SELL:
+            return this->asks.depth(out, n);
+    }
+    return 0;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+void OrderBook<Backend, Sink, Stats>::save_snapshot(
+    std::ostream &stream, std::uint64_t journal) const {
+    snapshot::Writer writer(stream, this->sequence_, this->order_index.size(),
+                            journal);
+    save_side(writer, this->bids);
+    save_side(writer, this->asks);
+    writer.finish();
+}
+
+template <typename Backend, typename Sink, typename Stats>
+template <typename Table>
+void OrderBook<Backend, Sink, Stats>::save_side(snapshot::Writer &writer,
+                                                Table const &table) {
+    std::uint32_t levels = 0;
+    table.for_each_limit([&levels](Price, Limit const &) { ++levels; });
+    writer.side(levels);
+
+    table.for_each_limit([&writer](Price price, Limit const &limit) {
+        writer.level(price, static_cast<std::uint32_t>(limit.size()));
+        for (auto const &order : limit) {
+            writer.order(order.id, order.quantity);
+        }
+    });
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::load_snapshot(std::string_view data) {
+    if (!this->order_index.empty()) {
+        spdlog::error("Cannot load a snapshot: the book is not empty");
+        return false;
+    }
+    snapshot::Reader reader(data);
+    if (reader.error() != nullptr) {
+        spdlog::error("Cannot load a snapshot: {}", reader.error());
+        return false;
+    }
+    if (!this->check_snapshot(reader)) {
+        return false;
+    }
+
+    this->reserve(reader.orders());
+    for (snapshot::Level level; reader.next(level);) {
+        // Since we use an enum, we would get a warning if our switch wasn't
+        // exhaustive
+        switch (level.side) {
+            case OrderSide::BUY:
+                this->load_level(this->bids, level);
+                break;
+            case OrderSide::SELL:
+                this->load_level(this->asks, level);
+                break;
+        }
+    }
+    this->sequence_ = reader.sequence();
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+bool OrderBook<Backend, Sink, Stats>::check_snapshot(
+    snapshot::Reader reader) const {
+    std::unordered_set<OrderId> ids;
+    ids.reserve(reader.orders());
+    for (snapshot::Level level; reader.next(level);) {
+        auto const accepted = level.side == OrderSide::BUY
+                                  ? this->bids.accepts(level.price)
+                                  : this->asks.accepts(level.price);
+        if (!accepted) {
+            spdlog::error("Cannot load a snapshot: price={} is outside the "
+                          "book",
+                          level.price);
+            return false;
+        }
+        for (std::size_t i = 0; i < level.orders; ++i) {
+            auto const order = snapshot::Reader::order(level, i);
+            if (order.quantity <= 0 || !ids.insert(order.id).second) {
+                spdlog::error("Cannot load a snapshot: invalid order id={}",
+                              order.id);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Backend, typename Sink, typename Stats>
+template <typename Table>
+void OrderBook<Backend, Sink, Stats>::load_level(Table &table,
+                                                 snapshot::Level const &level) {
+    // One lookup per level, the orders are appended in priority order
+    auto &limit = table.limit(level.price);
+    for (std::size_t i = 0; i < level.orders; ++i) {
+        auto const order = snapshot::Reader::order(level, i);
+        auto const slot = limit.push_back(order);
+        this->order_index.emplace(order.id,
+                                  OrderHandle{level.side, &limit, slot});
+    }
+    table.level_changed(level.price, limit);
+}
 
-}  // namespace ob
\ No newline at end of file
+}  // namespace ob
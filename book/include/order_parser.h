@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "order.h"
+
+namespace ob {
+
+//! A line of an orders file which could not be parsed.
+struct ParseError final {
+    std::size_t offset;  //!< Position of the start of the line, in bytes
+    char const *reason;  //!< What is wrong with the line
+};
+
+//! Orders parsed from a file, and the lines that were rejected.
+struct ParsedOrders final {
+    std::vector<std::pair<OrderType, Order>> orders;  //!< In file order
+    std::vector<ParseError> errors;                   //!< In file order
+};
+
+//! One line read by an OrderReader: either an order or an error.
+struct ParsedLine final {
+    std::size_t offset;  //!< Position of the start of the line, in bytes
+    char const *error;   //!< What is wrong with the line, null if valid
+    OrderType type;      //!< Only set for valid lines
+    //! Instrument of the order, empty if the line has no symbol field.
+    //! Points into the text being read.
+    std::string_view symbol;
+    Order order;         //!< Only set for valid lines
+};
+
+/** \brief Read orders one line at a time.
+ *
+ * Each line is `type,id,side,quantity,price`, e.g. `A,100000,S,1,1075`,
+ * optionally with a symbol after the type: `A,AAPL,100000,S,1,1075`, and a
+ * time in force at the end: `A,100000,S,1,MKT,IOC` (GTC if there is none).
+ * `MKT` as the price makes a market order.
+ * Numbers are read directly from the text, without copying the fields, so
+ * the text can be a memory-mapped file (see MappedFile). Nothing is
+ * buffered: orders can be processed as soon as they are read, and memory use
+ * does not depend on the size of the text.
+ */
+class OrderReader final {
+   public:
+    explicit OrderReader(std::string_view text);
+
+    /** \brief Read the next non-empty line.
+     *
+     * \return false once the whole text has been read.
+     */
+    bool next(ParsedLine &);
+
+    //! Number of bytes read so far.
+    std::size_t offset() const {
+        return static_cast<std::size_t>(this->position_ - this->begin_);
+    }
+
+   private:
+    char const *begin_;     //!< Start of the text
+    char const *position_;  //!< Start of the next line
+    char const *end_;       //!< End of the text
+};
+
+/** \brief Call `on_order(type, order)` for every valid line of the text, and
+ *         `on_error(ParseError)` for every malformed one, in order.
+ */
+template <typename OnOrder, typename OnError>
+void for_each_order(std::string_view text, OnOrder &&on_order,
+                    OnError &&on_error) {
+    OrderReader reader(text);
+    for (ParsedLine line; reader.next(line);) {
+        if (line.error != nullptr) {
+            on_error(ParseError{line.offset, line.error});
+        } else {
+            on_order(line.type, line.order);
+        }
+    }
+}
+
+/** \brief Deserialize text into Order objects
+ *
+ * Same as for_each_order, keeping everything in memory. Malformed lines are
+ * skipped and reported with their position.
+ */
+ParsedOrders parse_orders(std::string_view text);
+
+}  // namespace ob
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "order_parser.h"
+#include "work_pool.h"
+
+namespace ob {
+
+/** \brief Read orders in batches, parsed ahead by a pool of threads.
+ *
+ * The text is cut into chunks of about `chunk_size` bytes, each ending at
+ * the end of a line, and the chunks are parsed in parallel into batches of
+ * ParsedLine, sized from the number of lines of their chunk. The batches
+ * come out of next() in the order of the text, so that a single thread can
+ * match them as if it had parsed them itself: the lines and their offsets
+ * are the same as with an OrderReader.
+ *
+ * At most one chunk per thread beyond the current batch is parsed ahead, so
+ * memory use does not depend on the size of the text. The batches are
+ * reused from one chunk to the next.
+ */
+class ParallelOrderReader final {
+   public:
+    static constexpr std::size_t default_chunk_size = 1 << 20;
+
+    //! Parse `text` on `threads` threads, or one per core if 0.
+    ParallelOrderReader(std::string_view text, std::size_t threads,
+                        std::size_t chunk_size = default_chunk_size);
+
+    //! Wait for the chunks still being parsed.
+    ~ParallelOrderReader() = default;
+
+    ParallelOrderReader(ParallelOrderReader const &) = delete;
+    ParallelOrderReader &operator=(ParallelOrderReader const &) = delete;
+
+    /** \brief Next batch of lines, in the order of the text.
+     *
+     * The batch is valid until the next call. The empty lines are skipped,
+     * but a batch may still be empty if its chunk only has empty lines.
+     *
+     * \return null once the whole text has been read.
+     */
+    std::vector<ParsedLine> const *next();
+
+    //! Number of bytes of the text in the batches returned so far.
+    std::size_t offset() const { return this->consumed_; }
+
+   private:
+    //! A chunk being parsed, or parsed and waiting to be read.
+    struct Batch final {
+        std::size_t begin = 0;          //!< Offset of the chunk in the text
+        std::size_t end = 0;            //!< Offset after the chunk
+        std::vector<ParsedLine> lines;  //!< Of the chunk, once ready
+        bool cut = false;               //!< Whether it has a chunk
+        bool ready = false;             //!< Guarded by the mutex
+    };
+
+    //! Cut the next chunk and have it parsed into `batch`.
+    void schedule(Batch &batch);
+
+    //! Parse a chunk, on a thread of the pool.
+    void parse(Batch &batch);
+
+    std::string_view text_;
+    std::size_t chunk_size_;
+    std::size_t scheduled_ = 0;  //!< Offset of the next chunk to cut
+    std::size_t consumed_ = 0;   //!< Offset after the last batch read
+    std::size_t current_ = 0;    //!< Batch read next
+    Batch *previous_ = nullptr;  //!< Batch returned by the last call
+
+    std::mutex mutex_;
+    std::condition_variable parsed_;  //!< A batch is ready
+    std::vector<Batch> batches_;      //!< Used round-robin
+
+    //! Destroyed first, once the chunks being parsed are done
+    WorkPool pool_;
+};
+
+}  // namespace ob
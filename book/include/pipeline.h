@@ -0,0 +1,265 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "events.h"
+#include "order.h"
+#include "order_book.h"
+#include "price_ladder.h"
+#include "spsc_ring.h"
+#include "thread_affinity.h"
+
+namespace ob {
+
+//! Any event sent by a book, as carried by a ring.
+using BookEvent =
+    std::variant<Trade, OrderAdded, OrderCancelled, OrderReduced>;
+
+//! Event sink pushing every event to a ring, for another thread to report.
+//! Waits for room when the ring is full.
+template <typename Wait = BackOff>
+struct RingSink final {
+    SpscRing<BookEvent> *ring = nullptr;
+    Wait wait;
+
+    void on_trade(Trade const &e) { this->ring->push(e, this->wait); }
+    void on_order_added(OrderAdded const &e) {
+        this->ring->push(e, this->wait);
+    }
+    void on_order_cancelled(OrderCancelled const &e) {
+        this->ring->push(e, this->wait);
+    }
+    void on_order_reduced(OrderReduced const &e) {
+        this->ring->push(e, this->wait);
+    }
+};
+
+//! Time spent by orders in a queue, from push to pop.
+struct QueueLatency final {
+    std::uint64_t count = 0;     //!< Number of orders measured
+    std::uint64_t total_ns = 0;  //!< Sum of the latencies
+    std::uint64_t max_ns = 0;    //!< Worst latency
+
+    double mean_ns() const {
+        return this->count == 0 ? 0.0
+                                : static_cast<double>(this->total_ns) /
+                                      static_cast<double>(this->count);
+    }
+};
+
+//! Sizes of the rings of a Pipeline, and where its threads run.
+struct PipelineConfig final {
+    std::size_t order_capacity = 1 << 14;  //!< Orders waiting to be matched
+    std::size_t event_capacity = 1 << 16;  //!< Events waiting to be reported
+    std::size_t batch_size = 64;           //!< Items popped at once
+    bool pin_threads = false;  //!< Matching on core 1, reporting on core 2
+    LadderConfig ladder;       //!< Price range of the book
+};
+
+/** \brief One book matched on its own thread, between two rings.
+ *
+ * The submitting thread (e.g. the parser) pushes orders to the order ring.
+ * The matching thread owns the book: it pops orders by batches and pushes
+ * the events of the book to the event ring. The reporting thread pops the
+ * events and hands them to the output sink (e.g. LogSink), so formatting
+ * never slows down matching.
+ *
+ * Orders are timestamped when submitted, and the time they spent in the
+ * order ring is measured when the matching thread pops them.
+ *
+ * Only one thread may submit orders. The book, the output sink and the
+ * latency can be read once the pipeline is stopped.
+ */
+template <typename Backend = MapBackend, typename Output = NullSink,
+          typename Wait = BackOff>
+class Pipeline final {
+   public:
+    using Book = OrderBook<Backend, RingSink<Wait>>;
+
+    //! Start the matching and reporting threads.
+    explicit Pipeline(PipelineConfig const &config = {},
+                      Output output = Output());
+
+    //! Process the orders still queued, then join the threads.
+    ~Pipeline();
+
+    Pipeline(Pipeline const &) = delete;
+    Pipeline &operator=(Pipeline const &) = delete;
+
+    //! Queue an order, waiting if the order ring is full.
+    void submit(OrderType, Order const &);
+
+    //! Wait until every order is matched and every event reported.
+    void stop();
+
+    Book const &book() const { return this->book_; }
+
+    Output const &output() const { return this->output_; }
+
+    //! Time spent by the orders in the order ring.
+    QueueLatency const &latency() const { return this->latency_; }
+
+   private:
+    //! An order on its way to the matching thread.
+    struct Inbound final {
+        OrderType type;
+        Order order;
+        std::int64_t submitted_ns;  //!< When submit was called
+    };
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    //! Body of the matching thread.
+    void match();
+
+    //! Body of the reporting thread.
+    void report();
+
+    void deliver(Trade const &e) { this->output_.on_trade(e); }
+    void deliver(OrderAdded const &e) { this->output_.on_order_added(e); }
+    void deliver(OrderCancelled const &e) {
+        this->output_.on_order_cancelled(e);
+    }
+    void deliver(OrderReduced const &e) { this->output_.on_order_reduced(e); }
+
+    PipelineConfig config_;
+    SpscRing<Inbound> orders_;
+    SpscRing<BookEvent> events_;
+    Book book_;             //!< Matching thread only
+    Output output_;         //!< Reporting thread only
+    QueueLatency latency_;  //!< Matching thread only
+    Wait submit_wait_;      //!< Submitting thread only
+
+    std::atomic<bool> submitted_{false};  //!< No more orders will come
+    std::atomic<bool> matched_{false};    //!< No more events will come
+    std::thread matcher_;
+    std::thread reporter_;
+    bool stopped_ = false;
+};
+
+/**
+ * Library implementation
+ */
+
+template <typename Backend, typename Output, typename Wait>
+Pipeline<Backend, Output, Wait>::Pipeline(PipelineConfig const &config,
+                                          Output output)
+    : config_(config),
+      orders_(config.order_capacity),
+      events_(config.event_capacity),
+      book_(config.ladder, RingSink<Wait>{&this->events_, Wait()}),
+      output_(std::move(output)) {
+    this->matcher_ = std::thread([this] { this->match(); });
+    this->reporter_ = std::thread([this] { this->report(); });
+}
+
+template <typename Backend, typename Output, typename Wait>
+Pipeline<Backend, Output, Wait>::~Pipeline() {
+    this->stop();
+}
+
+template <typename Backend, typename Output, typename Wait>
+void Pipeline<Backend, Output, Wait>::submit(OrderType type,
+                                             Order const &order) {
+    this->orders_.push(Inbound{type, order, now()}, this->submit_wait_);
+}
+
+template <typename Backend, typename Output, typename Wait>
+void Pipeline<Backend, Output, Wait>::stop() {
+    if (this->stopped_) {
+        return;
+    }
+    this->submitted_.store(true, std::memory_order_release);
+    this->matcher_.join();
+    this->reporter_.join();
+    this->stopped_ = true;
+}
+
+template <typename Backend, typename Output, typename Wait>
+void Pipeline<Backend, Output, Wait>::match() {
+    if (this->config_.pin_threads) {
+        pin_current_thread(1);
+    }
+
+    std::vector<Inbound> batch(this->config_.batch_size);
+    Wait wait;
+    for (;;) {
+        auto const count = this->orders_.pop_batch(batch.data(), batch.size());
+        if (count == 0) {
+            // The flag is read before checking the ring again, so the last
+            // orders cannot be missed
+            if (this->submitted_.load(std::memory_order_acquire) &&
+                this->orders_.empty()) {
+                break;
+            }
+            wait();
+            continue;
+        }
+        wait.reset();
+
+        // One clock read per batch
+        auto const received = now();
+        for (std::size_t i = 0; i < count; ++i) {
+            auto &message = batch[i];
+            auto const latency =
+                static_cast<std::uint64_t>(received - message.submitted_ns);
+            ++this->latency_.count;
+            this->latency_.total_ns += latency;
+            this->latency_.max_ns = std::max(this->latency_.max_ns, latency);
+
+            // Since we use an enum, we would get a warning if our switch
+            // wasn't exhaustive
+            switch (message.type) {
+                case OrderType::NEW:
+                    this->book_.place_order(message.order);
+                    break;
+                case OrderType::CANCEL:
+                    this->book_.cancel(message.order);
+                    break;
+                case OrderType::MODIFY:
+                    this->book_.amend(message.order);
+                    break;
+            }
+        }
+    }
+    this->matched_.store(true, std::memory_order_release);
+}
+
+template <typename Backend, typename Output, typename Wait>
+void Pipeline<Backend, Output, Wait>::report() {
+    if (this->config_.pin_threads) {
+        pin_current_thread(2);
+    }
+
+    std::vector<BookEvent> batch(this->config_.batch_size);
+    Wait wait;
+    for (;;) {
+        auto const count = this->events_.pop_batch(batch.data(), batch.size());
+        if (count == 0) {
+            if (this->matched_.load(std::memory_order_acquire) &&
+                this->events_.empty()) {
+                break;
+            }
+            wait();
+            continue;
+        }
+        wait.reset();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            std::visit([this](auto const &event) { this->deliver(event); },
+                       batch[i]);
+        }
+    }
+}
+
+}  // namespace ob
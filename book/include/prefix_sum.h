@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "order.h"
+
+namespace ob::detail {
+
+/** \brief Number of values, from the first, whose sum does not exceed
+ *         `budget`.
+ *
+ * In other words the index of the first running sum above the budget, or
+ * `count` if there is none. The values must not be negative, zeros are
+ * simply included in the prefix. Sums are computed on 64 bits.
+ *
+ * This picks the fastest kernel the CPU supports, once, on the first call:
+ * AVX2 on x86-64 processors that have it, plain C++ otherwise.
+ */
+std::size_t prefix_within(Quantity const *values, std::size_t count,
+                          std::int64_t budget);
+
+//! Portable kernel of prefix_within, one value at a time.
+std::size_t prefix_within_scalar(Quantity const *values, std::size_t count,
+                                 std::int64_t budget);
+
+/** \brief AVX2 kernel of prefix_within, 16 values at a time.
+ *
+ * Must only be called if has_avx2().
+ */
+std::size_t prefix_within_avx2(Quantity const *values, std::size_t count,
+                               std::int64_t budget);
+
+//! Whether this CPU, and the OS, support AVX2.
+bool has_avx2();
+
+}  // namespace ob::detail
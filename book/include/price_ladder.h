@@ -0,0 +1,522 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "bits.h"
+#include "fenwick_tree.h"
+#include "limit.h"
+#include "order.h"
+
+namespace ob {
+
+/** \brief Price range covered by a book.
+ *
+ * Only backends with a fixed price range use it, the map backend accepts any
+ * price.
+ */
+struct LadderConfig final {
+    Price base = 0;                //!< Lowest price in the book
+    Price tick = 1;                //!< Price increment between two limits
+    std::size_t levels = 1 << 16;  //!< Number of limits on each side
+};
+
+//! Aggregated view of one price level, as published in market data.
+struct DepthLevel final {
+    Price price;         //!< Price of the level
+    Quantity quantity;   //!< Total quantity resting at that price
+    std::size_t orders;  //!< Number of orders resting at that price
+};
+
+inline bool operator==(DepthLevel const &left, DepthLevel const &right) {
+    return left.price == right.price && left.quantity == right.quantity &&
+           left.orders == right.orders;
+}
+
+//! Cost of taking a quantity from one side of the book, best price first.
+struct FillEstimate final {
+    Price worst_price;      //!< Price of the last level reached
+    std::int64_t quantity;  //!< Quantity taken
+    std::int64_t notional;  //!< Sum of the prices times quantities taken
+
+    //! Volume-weighted average price.
+    double vwap() const {
+        return static_cast<double>(this->notional) /
+               static_cast<double>(this->quantity);
+    }
+};
+
+/** \brief Price levels of one side of the book, stored in a std::map.
+ *
+ * This is the reference implementation: simple, unbounded, and one tree node
+ * per limit. The ordering puts the best price first.
+ *
+ * Tree nodes and the orders of their limits come from a memory resource.
+ * Emptied limits are not freed but kept aside, still in their nodes, and
+ * reused for the next new prices: a warm ladder does not allocate.
+ */
+template <typename Compare>
+struct MapLadder final : std::pmr::map<Price, Limit, Compare> {
+    using Base = std::pmr::map<Price, Limit, Compare>;
+
+    //! Emptied limits kept for new prices, at most.
+    static constexpr std::size_t max_spare_limits = 256;
+
+    MapLadder() : MapLadder(std::pmr::get_default_resource()) {}
+
+    explicit MapLadder(std::pmr::memory_resource *memory)
+        : Base(memory) {
+        this->spares_.reserve(max_spare_limits);
+    }
+
+    //! Any price fits in a map, so the configuration is not needed.
+    explicit MapLadder(
+        LadderConfig const &,
+        std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : MapLadder(memory) {}
+
+    //! Every price can be stored.
+    bool accepts(Price) const { return true; }
+
+    //! Price of the best limit. The ladder must not be empty.
+    Price best_price() const { return this->begin()->first; }
+
+    //! Best limit. The ladder must not be empty.
+    Limit &best() { return this->begin()->second; }
+
+    //! Remove the best limit once it has been emptied.
+    void pop_best() { this->retire(this->begin()); }
+
+    //! Get the limit at a given price, creating it if needed.
+    Limit &limit(Price price) {
+        auto found = this->lower_bound(price);
+        if (found != this->end() && found->first == price) {
+            return found->second;
+        }
+        if (this->spares_.empty()) {
+            return this
+                ->emplace_hint(found, std::piecewise_construct,
+                               std::forward_as_tuple(price),
+                               std::forward_as_tuple())
+                ->second;
+        }
+        auto spare = std::move(this->spares_.back());
+        this->spares_.pop_back();
+        spare.key() = price;
+        return this->insert(found, std::move(spare))->second;
+    }
+
+    //! Remove an emptied limit.
+    void erase_limit(Price price) { this->retire(this->find(price)); }
+
+    //! Limit at a given price, or null if there is none.
+    Limit const *find_limit(Price price) const {
+        auto found = this->find(price);
+        return found == this->end() ? nullptr : &found->second;
+    }
+
+    //! Call `f(price, limit)` on every limit, best price first.
+    template <typename F>
+    void for_each_limit(F &&f) const {
+        for (auto const &p : *this) {
+            f(p.first, p.second);
+        }
+    }
+
+    //! Level totals are read directly from the limits.
+    void level_changed(Price, Limit const &) {}
+
+    //! Quantity resting at `limit` or better, summing the level totals.
+    std::int64_t quantity_until(Price limit) const {
+        std::int64_t quantity = 0;
+        this->for_each_limit_until(
+            limit, [&quantity](Price, Limit const &level) {
+                quantity += level.quantity();
+            });
+        return quantity;
+    }
+
+    /** \brief Take `quantity` from the levels, best first.
+     *
+     * \return false if the ladder holds less than that.
+     */
+    bool estimate_fill(std::int64_t quantity, FillEstimate &fill) const {
+        fill = FillEstimate{0, 0, 0};
+        if (quantity <= 0) {
+            return false;
+        }
+        for (auto it = this->begin(); it != this->end(); ++it) {
+            auto const taken = std::min<std::int64_t>(
+                it->second.quantity(), quantity - fill.quantity);
+            fill.worst_price = it->first;
+            fill.quantity += taken;
+            fill.notional += taken * it->first;
+            if (fill.quantity == quantity) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** \brief Whether the levels at `limit` or better hold at least
+     *         `quantity`, from their totals alone.
+     */
+    bool covers(Price limit, Quantity quantity) const {
+        // Levels past the limit are the ones it would be ordered before
+        std::int64_t available = 0;
+        for (auto it = this->begin();
+             it != this->end() && !Compare()(limit, it->first); ++it) {
+            available += it->second.quantity();
+            if (available >= quantity) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Call `f(price, limit)` on every limit at `limit` or better.
+    template <typename F>
+    void for_each_limit_until(Price limit, F &&f) const {
+        for (auto it = this->begin();
+             it != this->end() && !Compare()(limit, it->first); ++it) {
+            f(it->first, it->second);
+        }
+    }
+
+    //! Nothing to prefetch: finding the limit is the expensive part.
+    void prefetch(Price) const {}
+
+    //! Copy the `n` best levels to `out`, and return how many there were.
+    std::size_t depth(DepthLevel *out, std::size_t n) const {
+        std::size_t count = 0;
+        for (auto it = this->begin(); count < n && it != this->end(); ++it) {
+            out[count++] = DepthLevel{it->first, it->second.quantity(),
+                                      it->second.size()};
+        }
+        return count;
+    }
+
+   private:
+    //! Keep an emptied limit for a later price, or free it.
+    void retire(typename Base::iterator limit) {
+        if (this->spares_.size() < max_spare_limits) {
+            this->spares_.push_back(this->extract(limit));
+        } else {
+            this->erase(limit);
+        }
+    }
+
+    //! Emptied limits. Node handles hold their own allocator, so they are
+    //! not kept in a std::pmr::vector.
+    std::vector<typename Base::node_type> spares_;
+};
+
+/** \brief Price levels of one side of the book, stored in a flat array.
+ *
+ * Limits live at index `(price - base) / tick`, so finding one is an
+ * arithmetic operation instead of a tree search, and no allocation happens
+ * when a price level appears. The index of the best limit is cached, and a
+ * bitmap of the non-empty limits lets us jump to the next one 64 levels at a
+ * time when the best limit empties.
+ *
+ * The level totals, and their prices times quantities, are also kept in
+ * Fenwick trees indexed like the limits, so the quantity available up to a
+ * price, or the cost of taking a quantity, are O(log n) whatever the number
+ * of levels in between.
+ *
+ * Prices outside of the configured range cannot be stored.
+ */
+template <OrderSide Side>
+class FlatLadder final {
+   public:
+    //! The limits take the memory of their orders from `memory`.
+    explicit FlatLadder(
+        LadderConfig const &config = {},
+        std::pmr::memory_resource *memory = std::pmr::get_default_resource())
+        : config_(config),
+          limits_(config.levels, memory),
+          occupied_((config.levels + 63) / 64),
+          totals_(config.levels),
+          quantities_(config.levels),
+          notionals_(config.levels) {}
+
+    //! Whether the price is in range and on a tick.
+    bool accepts(Price price) const {
+        return price >= this->config_.base &&
+               (price - this->config_.base) % this->config_.tick == 0 &&
+               this->index_of(price) < this->config_.levels;
+    }
+
+    bool empty() const { return this->best_ == npos; }
+
+    //! Price of the best limit. The ladder must not be empty.
+    Price best_price() const { return this->price_of(this->best_); }
+
+    //! Best limit. The ladder must not be empty.
+    Limit &best() { return this->limits_[this->best_]; }
+
+    //! Remove the best limit once it has been emptied.
+    void pop_best() { this->clear(this->best_); }
+
+    //! Get the limit at a given price, marking it as used.
+    Limit &limit(Price price) {
+        auto const index = this->index_of(price);
+        this->occupied_[index / 64] |= std::uint64_t{1} << (index % 64);
+        if (this->best_ == npos || is_better(index, this->best_)) {
+            this->best_ = index;
+        }
+        return this->limits_[index];
+    }
+
+    //! Remove an emptied limit.
+    void erase_limit(Price price) { this->clear(this->index_of(price)); }
+
+    //! Limit at a given price, or null if there is none.
+    Limit const *find_limit(Price price) const {
+        if (!this->accepts(price)) {
+            return nullptr;
+        }
+        auto const &limit = this->limits_[this->index_of(price)];
+        return limit.empty() ? nullptr : &limit;
+    }
+
+    //! Call `f(price, limit)` on every limit, best price first.
+    template <typename F>
+    void for_each_limit(F &&f) const {
+        for (auto index = this->best_; index != npos;
+             index = this->next(index)) {
+            f(this->price_of(index), this->limits_[index]);
+        }
+    }
+
+    //! Update the trees after the total of a limit changed.
+    void level_changed(Price price, Limit const &limit) {
+        auto const index = this->index_of(price);
+        auto const delta = std::int64_t{limit.quantity()} -
+                           std::int64_t{this->totals_[index]};
+        if (delta == 0) {
+            return;
+        }
+        this->totals_[index] = limit.quantity();
+        this->quantities_.add(index, delta);
+        this->notionals_.add(index, delta * price);
+    }
+
+    //! Quantity resting at `limit` or better, in O(log n).
+    std::int64_t quantity_until(Price limit) const {
+        auto const offset = std::int64_t{limit} - this->config_.base;
+        auto const levels = static_cast<std::int64_t>(this->config_.levels);
+        if constexpr (Side == OrderSide::BUY) {
+            // Levels from the first one at or above the limit
+            auto const first =
+                offset <= 0 ? 0
+                            : (offset + this->config_.tick - 1) /
+                                  this->config_.tick;
+            if (first >= levels) {
+                return 0;
+            }
+            return this->total() -
+                   this->quantities_.prefix(static_cast<std::size_t>(first));
+        } else {
+            // Levels up to the last one at or below the limit
+            if (offset < 0) {
+                return 0;
+            }
+            auto const count = std::min(offset / this->config_.tick + 1,
+                                        levels);
+            return this->quantities_.prefix(static_cast<std::size_t>(count));
+        }
+    }
+
+    /** \brief Take `quantity` from the levels, best first, in O(log n).
+     *
+     * \return false if the ladder holds less than that.
+     */
+    bool estimate_fill(std::int64_t quantity, FillEstimate &fill) const {
+        fill = FillEstimate{0, 0, 0};
+        auto const total = this->total();
+        if (quantity <= 0 || total < quantity) {
+            return false;
+        }
+
+        // Index of the level completing the quantity, and what the better
+        // levels hold
+        std::size_t index;
+        std::int64_t before;
+        std::int64_t notional_before;
+        if constexpr (Side == OrderSide::BUY) {
+            index = this->quantities_.last_at_most(total - quantity);
+            before = total - this->quantities_.prefix(index + 1);
+            notional_before = this->notionals_.prefix(this->config_.levels) -
+                              this->notionals_.prefix(index + 1);
+        } else {
+            index = this->quantities_.last_at_most(quantity - 1);
+            before = this->quantities_.prefix(index);
+            notional_before = this->notionals_.prefix(index);
+        }
+
+        fill.worst_price = this->price_of(index);
+        fill.quantity = quantity;
+        fill.notional =
+            notional_before + (quantity - before) * fill.worst_price;
+        return true;
+    }
+
+    //! Whether the levels at `limit` or better hold at least `quantity`.
+    bool covers(Price limit, Quantity quantity) const {
+        return this->quantity_until(limit) >= quantity;
+    }
+
+    //! Call `f(price, limit)` on every limit at `limit` or better.
+    template <typename F>
+    void for_each_limit_until(Price limit, F &&f) const {
+        for (auto index = this->best_;
+             index != npos && !is_worse(this->price_of(index), limit);
+             index = this->next(index)) {
+            f(this->price_of(index), this->limits_[index]);
+        }
+    }
+
+    //! Start loading the limit at a price, if it can be stored.
+    void prefetch(Price price) const {
+        if (this->accepts(price)) {
+            detail::prefetch(&this->limits_[this->index_of(price)]);
+        }
+    }
+
+    //! Copy the `n` best levels to `out`, and return how many there were.
+    std::size_t depth(DepthLevel *out, std::size_t n) const {
+        std::size_t count = 0;
+        for (auto index = this->best_; count < n && index != npos;
+             index = this->next(index)) {
+            auto const &limit = this->limits_[index];
+            out[count++] = DepthLevel{this->price_of(index), limit.quantity(),
+                                      limit.size()};
+        }
+        return count;
+    }
+
+   private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    //! Bids are best at the top of the ladder, asks at the bottom.
+    static bool is_better(std::size_t left, std::size_t right) {
+        if constexpr (Side == OrderSide::BUY) {
+            return left > right;
+        } else {
+            return left < right;
+        }
+    }
+
+    //! Whether a price is worse than another one, for this side.
+    static bool is_worse(Price price, Price than) {
+        if constexpr (Side == OrderSide::BUY) {
+            return price < than;
+        } else {
+            return price > than;
+        }
+    }
+
+    std::size_t index_of(Price price) const {
+        return static_cast<std::size_t>((price - this->config_.base) /
+                                        this->config_.tick);
+    }
+
+    Price price_of(std::size_t index) const {
+        return this->config_.base +
+               static_cast<Price>(index) * this->config_.tick;
+    }
+
+    void clear(std::size_t index) {
+        this->occupied_[index / 64] &= ~(std::uint64_t{1} << (index % 64));
+        if (index == this->best_) {
+            this->best_ = this->next(index);
+        }
+    }
+
+    //! Next non-empty limit after `index`, in priority order.
+    std::size_t next(std::size_t index) const {
+        if constexpr (Side == OrderSide::BUY) {
+            return index == 0 ? npos : this->last_at_or_below(index - 1);
+        } else {
+            return this->first_at_or_above(index + 1);
+        }
+    }
+
+    std::size_t first_at_or_above(std::size_t index) const {
+        auto word = index / 64;
+        if (word >= this->occupied_.size()) {
+            return npos;
+        }
+        auto bits =
+            this->occupied_[word] & (~std::uint64_t{0} << (index % 64));
+        while (bits == 0) {
+            if (++word == this->occupied_.size()) {
+                return npos;
+            }
+            bits = this->occupied_[word];
+        }
+        return word * 64 + detail::lowest_bit(bits);
+    }
+
+    std::size_t last_at_or_below(std::size_t index) const {
+        auto word = index / 64;
+        auto bits =
+            this->occupied_[word] & (~std::uint64_t{0} >> (63 - index % 64));
+        while (bits == 0) {
+            if (word == 0) {
+                return npos;
+            }
+            bits = this->occupied_[--word];
+        }
+        return word * 64 + detail::highest_bit(bits);
+    }
+
+    //! Quantity of the whole ladder.
+    std::int64_t total() const {
+        return this->quantities_.prefix(this->config_.levels);
+    }
+
+    LadderConfig config_;
+    std::pmr::vector<Limit> limits_;       //!< One per tick, never resized
+    std::vector<std::uint64_t> occupied_;  //!< One bit per non-empty limit
+    std::size_t best_ = npos;              //!< Index of the best limit
+    std::vector<Quantity> totals_;         //!< Level totals in the trees
+    FenwickTree quantities_;               //!< Of the level totals
+    FenwickTree notionals_;                //!< Of price times level total
+};
+
+/** \brief Using std:map with default ordering, to hit the smallest asks first
+ *         when we place a bid.
+ *
+ * We could easily reserve a few limits to reduce the number of allocations.
+ */
+using Asks = MapLadder<std::less<Price>>;
+
+/** \brief Using std:map with default ordering, to hit the largest bids first
+ *         when we place an ask.
+ *
+ * We could easily reserve a few limits to reduce the number of allocations.
+ */
+using Bids = MapLadder<std::greater<Price>>;
+
+//! Reference backend: one std::map per side.
+struct MapBackend final {
+    using Bids = ob::Bids;
+    using Asks = ob::Asks;
+};
+
+//! Backend storing each side in a fixed-size array of price levels.
+struct FlatBackend final {
+    using Bids = FlatLadder<OrderSide::BUY>;
+    using Asks = FlatLadder<OrderSide::SELL>;
+};
+
+}  // namespace ob
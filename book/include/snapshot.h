@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+#include "order.h"
+
+//! Binary images of the resting orders of a book
+namespace ob::snapshot {
+
+/** \brief Layout of a snapshot file.
+ *
+ * Every integer is little-endian. The file starts with a 40 bytes header:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 8    | magic, "OBSNAPSH"                        |
+ * | 8      | 2    | version                                  |
+ * | 10     | 6    | reserved, 0                              |
+ * | 16     | 8    | sequence number of the last level update |
+ * | 24     | 8    | number of orders                         |
+ * | 32     | 8    | last journal entry applied, 0 if none    |
+ *
+ * followed by the bids then the asks, each as a level count (4 bytes) and
+ * the levels, best price first. A level is its price and order count (4
+ * bytes each), then its orders in time priority, as ID and quantity (4 bytes
+ * each).
+ *
+ * The file ends with the 64-bit FNV-1a hash of everything before it.
+ */
+constexpr char magic[8] = {'O', 'B', 'S', 'N', 'A', 'P', 'S', 'H'};
+constexpr std::uint16_t version = 2;
+constexpr std::size_t header_size = 40;
+constexpr std::size_t level_size = 8;
+constexpr std::size_t order_size = 8;
+constexpr std::size_t checksum_size = 8;
+
+//! Whether the data starts like a snapshot.
+bool has_magic(std::string_view data);
+
+/** \brief Write a snapshot to a stream, one side, level and order at a time.
+ *
+ * The counts announced must match what is written. `journal` is the sequence
+ * number of the last journal entry applied to the book, so that recovering
+ * from the snapshot and the journal only replays the entries after it.
+ */
+class Writer final {
+   public:
+    Writer(std::ostream &, std::uint64_t sequence, std::uint64_t orders,
+           std::uint64_t journal = 0);
+
+    //! Start a side: bids first, then asks.
+    void side(std::uint32_t levels);
+
+    void level(Price, std::uint32_t orders);
+
+    void order(OrderId, Quantity);
+
+    //! Write the checksum. Nothing may be written after it.
+    void finish();
+
+   private:
+    void write(char const *data, std::size_t size);
+
+    std::ostream &stream_;
+    std::uint64_t hash_;
+};
+
+//! A level of a snapshot, decoded in place.
+struct Level final {
+    OrderSide side;
+    Price price;
+    std::uint32_t orders;  //!< Number of orders, see Reader::order
+    char const *data;      //!< First order
+};
+
+/** \brief Read a snapshot in place, for example from a MappedFile.
+ *
+ * The whole snapshot is checked when the reader is built, so reading the
+ * levels afterwards cannot fail.
+ */
+class Reader final {
+   public:
+    explicit Reader(std::string_view data);
+
+    //! Why the snapshot cannot be read, or null if it is valid.
+    char const *error() const { return this->error_; }
+
+    std::uint64_t sequence() const { return this->sequence_; }
+
+    //! Total number of orders, on both sides.
+    std::uint64_t orders() const { return this->orders_; }
+
+    //! Last journal entry applied to the book, 0 if none.
+    std::uint64_t journal() const { return this->journal_; }
+
+    /** \brief Read the next level, bids first.
+     *
+     * \return false once every level has been read.
+     */
+    bool next(Level &);
+
+    //! Decode an order of a level, `index` < `level.orders`.
+    static Order order(Level const &, std::size_t index);
+
+   private:
+    char const *position_ = nullptr;  //!< Next level, or side header
+    int sides_read_ = 0;              //!< 1 while reading bids, 2 for asks
+    std::uint32_t levels_left_ = 0;   //!< In the current side
+    std::uint64_t sequence_ = 0;
+    std::uint64_t orders_ = 0;
+    std::uint64_t journal_ = 0;
+    char const *error_ = nullptr;
+};
+
+}  // namespace ob::snapshot
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OB_RING_PAUSE() _mm_pause()
+#else
+#define OB_RING_PAUSE() ((void)0)
+#endif
+
+namespace ob {
+
+//! Size of a cache line on the machines we run on.
+constexpr std::size_t cache_line = 64;
+
+/** \brief Wait strategy spinning on the CPU.
+ *
+ * Lowest latency, but the waiting thread keeps its core busy: only use it
+ * with a core per thread.
+ */
+struct BusySpin final {
+    void operator()() { OB_RING_PAUSE(); }
+    void reset() {}
+};
+
+/** \brief Wait strategy spinning for a while, then yielding, then sleeping.
+ *
+ * Reacts quickly to a short gap, and gives the core back during a long one.
+ */
+class BackOff final {
+   public:
+    void operator()() {
+        if (this->waits_ < spins) {
+            OB_RING_PAUSE();
+        } else if (this->waits_ < spins + yields) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        ++this->waits_;
+    }
+
+    //! Call once the wait is over, to spin again next time.
+    void reset() { this->waits_ = 0; }
+
+   private:
+    static constexpr unsigned spins = 64;
+    static constexpr unsigned yields = 64;
+    unsigned waits_ = 0;
+};
+
+/** \brief Bounded single-producer/single-consumer queue.
+ *
+ * One thread pushes, another one pops, without locks: each side only writes
+ * its own index, and keeps a copy of the other side's index so it only reads
+ * it (and pulls its cache line) when the ring looks full or empty. Both
+ * indices live on their own cache line.
+ *
+ * The capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscRing final {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Items are copied in and out of the slots");
+
+   public:
+    explicit SpscRing(std::size_t capacity)
+        : mask_(round_up(capacity) - 1),
+          slots_(std::make_unique<T[]>(this->mask_ + 1)) {}
+
+    SpscRing(SpscRing const &) = delete;
+    SpscRing &operator=(SpscRing const &) = delete;
+
+    std::size_t capacity() const { return this->mask_ + 1; }
+
+    //! Whether there is nothing to pop. Only exact on the consumer side.
+    bool empty() const {
+        return this->head_.load(std::memory_order_relaxed) ==
+               this->tail_.load(std::memory_order_acquire);
+    }
+
+    /** \brief Add an item, unless the ring is full. Producer only.
+     *
+     * \return false if the ring is full.
+     */
+    bool try_push(T const &item) {
+        auto const tail = this->tail_.load(std::memory_order_relaxed);
+        if (tail - this->cached_head_ == this->capacity()) {
+            this->cached_head_ = this->head_.load(std::memory_order_acquire);
+            if (tail - this->cached_head_ == this->capacity()) {
+                return false;
+            }
+        }
+        this->slots_[tail & this->mask_] = item;
+        this->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! Add an item, waiting for room if the ring is full. Producer only.
+    template <typename Wait>
+    void push(T const &item, Wait &wait) {
+        while (!this->try_push(item)) {
+            wait();
+        }
+        wait.reset();
+    }
+
+    //! Take the oldest item, unless the ring is empty. Consumer only.
+    bool try_pop(T &item) { return this->pop_batch(&item, 1) == 1; }
+
+    /** \brief Take up to `max` items at once. Consumer only.
+     *
+     * The producer's index is read at most once for the whole batch.
+     *
+     * \return the number of items copied to `out`, 0 if the ring is empty.
+     */
+    std::size_t pop_batch(T *out, std::size_t max) {
+        auto const head = this->head_.load(std::memory_order_relaxed);
+        if (this->cached_tail_ - head < max) {
+            this->cached_tail_ = this->tail_.load(std::memory_order_acquire);
+        }
+        auto const count = std::min(this->cached_tail_ - head, max);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = this->slots_[(head + i) & this->mask_];
+        }
+        this->head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+   private:
+    static std::size_t round_up(std::size_t capacity) {
+        std::size_t result = 1;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Read-only after construction
+    std::size_t const mask_;
+    std::unique_ptr<T[]> const slots_;
+
+    // Written by the producer
+    alignas(cache_line) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+
+    // Written by the consumer
+    alignas(cache_line) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+};
+
+}  // namespace ob
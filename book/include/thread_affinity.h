@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+namespace ob {
+
+/** \brief Pin the calling thread to one CPU core.
+ *
+ * Cores are counted modulo the number of cores of the machine. Only
+ * supported on Linux, elsewhere the thread is left where it is.
+ *
+ * \return true if the thread was pinned.
+ */
+bool pin_current_thread(std::size_t core);
+
+}  // namespace ob
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "binary_format.h"
+#include "order.h"
+
+//! Messages exchanged with the order-entry gateway over TCP
+namespace ob::wire {
+
+/** \brief Requests, from a client to the gateway.
+ *
+ * A request is a record of the binary orders files, without a timestamp
+ * (see binary_format.h): 16 bytes holding a new order, a cancel or an
+ * amend. Requests are decoded in place from the receive buffer.
+ */
+constexpr std::size_t request_size = binary::record_size;
+
+//! What a report tells the client.
+enum class ReportKind : char {
+    ACCEPTED = 'A',   //!< A new order was matched, and the rest may rest
+    CANCELLED = 'X',  //!< A cancel removed the order
+    AMENDED = 'M',    //!< An amend was applied
+    REJECTED = 'R',   //!< A request was invalid, or refused by the book
+    FILL = 'F',       //!< One of the client's orders traded
+};
+
+/** \brief Reports, from the gateway to a client.
+ *
+ * Every request gets exactly one acknowledgement (ACCEPTED, CANCELLED,
+ * AMENDED or REJECTED), in the order of the requests of the connection.
+ * Fills are sent to both sides of a trade, an aggressive order's before its
+ * acknowledgement.
+ *
+ * Every integer is little-endian, and every report takes 24 bytes:
+ *
+ * | Offset | Size | Field                                            |
+ * |--------|------|--------------------------------------------------|
+ * | 0      | 1    | kind, see ReportKind                             |
+ * | 1      | 1    | side, 'B' or 'S'                                 |
+ * | 2      | 2    | reserved, 0                                      |
+ * | 4      | 4    | order ID                                         |
+ * | 8      | 4    | quantity: traded by a fill, left resting by acks |
+ * | 12     | 4    | price: of the trade, or of the order             |
+ * | 16     | 4    | fills: ID of the other order of the trade        |
+ * | 20     | 4    | fills: quantity left on the order after it       |
+ */
+struct Report final {
+    ReportKind kind;
+    OrderSide side;
+    OrderId id;
+    Quantity quantity;
+    Price price;
+    OrderId other_id;    //!< 0 unless a fill
+    Quantity remaining;  //!< 0 unless a fill
+};
+
+constexpr std::size_t report_size = 24;
+
+//! Write a report in `report_size` bytes.
+void encode(char *data, Report const &);
+
+/** \brief Read a report from `report_size` bytes.
+ *
+ * \return false if the kind or the side is invalid.
+ */
+bool decode(char const *data, Report &);
+
+}  // namespace ob::wire
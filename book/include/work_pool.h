@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ob {
+
+/** \brief Pool of threads running independent tasks, with work stealing.
+ *
+ * Every thread has its own queue, and tasks are dealt round-robin to the
+ * queues. A thread takes the oldest task of its queue, and once its queue is
+ * empty it steals the newest task of another queue, so no thread sits idle
+ * while a long task holds back the queue it came from.
+ *
+ * Tasks must not throw. Any thread may submit tasks, including the tasks
+ * themselves.
+ */
+class WorkPool final {
+   public:
+    using Task = std::function<void()>;
+
+    //! Start `threads` threads, or one per core if 0.
+    explicit WorkPool(std::size_t threads = 0);
+
+    //! Run the tasks still queued, then join the threads.
+    ~WorkPool();
+
+    WorkPool(WorkPool const &) = delete;
+    WorkPool &operator=(WorkPool const &) = delete;
+
+    void submit(Task task);
+
+    //! Wait until every task submitted so far has run.
+    void wait();
+
+    std::size_t thread_count() const { return this->workers_.size(); }
+
+   private:
+    //! A thread and its queue. Aligned so that two queues never share a
+    //! cache line.
+    struct alignas(64) Worker final {
+        std::mutex mutex;
+        std::deque<Task> tasks;  //!< Guarded by the mutex
+        std::thread thread;
+    };
+
+    //! Take a task from the queue of `self`, or else from another queue.
+    Task take(std::size_t self);
+
+    //! Body of a thread.
+    void run(std::size_t self);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<std::size_t> next_{0};  //!< Queue of the next task
+
+    std::mutex mutex_;
+    std::condition_variable ready_;  //!< A task was queued, or stopping
+    std::condition_variable idle_;   //!< Every task has run
+    std::size_t queued_ = 0;         //!< Tasks not taken, by the mutex
+    std::size_t unfinished_ = 0;     //!< Tasks not run, by the mutex
+    bool stopping_ = false;          //!< Guarded by the mutex
+};
+
+}  // namespace ob
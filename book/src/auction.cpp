@@ -0,0 +1,82 @@
+#include "auction.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace ob::detail {
+
+AuctionResult equilibrium(std::vector<DepthLevel> const &bids,
+                          std::vector<DepthLevel> const &asks) {
+    std::vector<Price> prices;
+    prices.reserve(bids.size() + asks.size());
+    for (auto const &level : bids) {
+        prices.push_back(level.price);
+    }
+    for (auto const &level : asks) {
+        prices.push_back(level.price);
+    }
+    std::sort(std::begin(prices), std::end(prices), std::greater<>());
+    prices.erase(std::unique(std::begin(prices), std::end(prices)),
+                 std::end(prices));
+
+    std::int64_t supply = 0;
+    for (auto const &level : asks) {
+        supply += level.quantity;
+    }
+
+    // From the highest price down, demand grows and supply shrinks: bids at
+    // or above the price join, asks above it leave
+    std::vector<AuctionResult> best;
+    std::int64_t demand = 0;
+    auto bid = std::begin(bids);
+    auto ask = std::rbegin(asks);
+    for (auto price : prices) {
+        for (; bid != std::end(bids) && bid->price >= price; ++bid) {
+            demand += bid->quantity;
+        }
+        for (; ask != std::rend(asks) && ask->price > price; ++ask) {
+            supply -= ask->quantity;
+        }
+
+        AuctionResult const candidate{price, std::min(demand, supply),
+                                      demand - supply};
+        if (candidate.volume == 0) {
+            continue;
+        }
+        if (!best.empty()) {
+            auto const &current = best.front();
+            if (candidate.volume < current.volume ||
+                (candidate.volume == current.volume &&
+                 std::abs(candidate.surplus) > std::abs(current.surplus))) {
+                continue;
+            }
+            if (candidate.volume > current.volume ||
+                std::abs(candidate.surplus) < std::abs(current.surplus)) {
+                best.clear();
+            }
+        }
+        best.push_back(candidate);
+    }
+
+    if (best.empty()) {
+        return AuctionResult{0, 0, 0};
+    }
+
+    // Candidates are from the highest price to the lowest
+    auto const buyers_left =
+        std::all_of(std::begin(best), std::end(best),
+                    [](AuctionResult const &r) { return r.surplus > 0; });
+    auto const sellers_left =
+        std::all_of(std::begin(best), std::end(best),
+                    [](AuctionResult const &r) { return r.surplus < 0; });
+    if (buyers_left) {
+        return best.front();
+    }
+    if (sellers_left) {
+        return best.back();
+    }
+    return best[(best.size() - 1) / 2];
+}
+
+}  // namespace ob::detail
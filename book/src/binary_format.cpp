@@ -0,0 +1,119 @@
+#include "binary_format.h"
+
+#include <algorithm>
+
+#include "little_endian.h"
+
+namespace ob::binary {
+
+using detail::load;
+using detail::store;
+
+bool has_magic(std::string_view data) {
+    return data.size() >= sizeof(magic) &&
+           std::equal(std::begin(magic), std::end(magic), data.data());
+}
+
+void encode(char *data, OrderType type, Order const &order) {
+    data[0] = OrderTypeToChar(type);
+    data[1] = order.side == OrderSide::BUY ? 'B' : 'S';
+    data[2] = static_cast<char>(order.time_in_force);
+    data[3] = 0;
+    store<std::int32_t>(data + 4, order.id);
+    store<std::int32_t>(data + 8, order.quantity);
+    store<std::int32_t>(data + 12, order.price);
+}
+
+bool decode(char const *data, Record &record) {
+    // The type letters are the ones used in the CSV files
+    auto const type = StringToOrderType.find(std::string_view(data, 1));
+    if (type == std::end(StringToOrderType)) {
+        return false;
+    }
+    record.type = type->second;
+
+    switch (data[1]) {
+        case 'B':
+            record.order.side = OrderSide::BUY;
+            break;
+        case 'S':
+            record.order.side = OrderSide::SELL;
+            break;
+        default:
+            return false;
+    }
+
+    if (!detail::valid_time_in_force(data[2])) {
+        return false;
+    }
+    record.order.time_in_force = static_cast<TimeInForce>(data[2]);
+
+    record.order.id = load<std::int32_t>(data + 4);
+    record.order.quantity = load<std::int32_t>(data + 8);
+    record.order.price = load<std::int32_t>(data + 12);
+    return true;
+}
+
+Writer::Writer(std::ostream &stream, bool timestamps)
+    : stream_(stream), timestamps_(timestamps) {
+    char header[header_size] = {};
+    std::copy(std::begin(magic), std::end(magic), header);
+    store<std::uint16_t>(header + 8, version);
+    store<std::uint16_t>(header + 10,
+                         static_cast<std::uint16_t>(
+                             timestamps ? timestamped_record_size
+                                        : record_size));
+    store<std::uint32_t>(header + 12, timestamps ? timestamps_flag : 0);
+    this->stream_.write(header, header_size);
+}
+
+void Writer::write(OrderType type, Order const &order,
+                   std::uint64_t timestamp) {
+    char record[timestamped_record_size] = {};
+    encode(record, type, order);
+    if (this->timestamps_) {
+        store<std::uint64_t>(record + 16, timestamp);
+    }
+    this->stream_.write(record, static_cast<std::streamsize>(
+                                    this->timestamps_ ? timestamped_record_size
+                                                      : record_size));
+}
+
+Reader::Reader(std::string_view data) {
+    if (data.size() < header_size || !has_magic(data)) {
+        this->error_ = "not a binary orders file";
+        return;
+    }
+    if (load<std::uint16_t>(data.data() + 8) != version) {
+        this->error_ = "unsupported version";
+        return;
+    }
+
+    auto const flags = load<std::uint32_t>(data.data() + 12);
+    this->record_size_ = (flags & timestamps_flag) ? timestamped_record_size
+                                                   : record_size;
+    if (load<std::uint16_t>(data.data() + 10) != this->record_size_) {
+        this->error_ = "unexpected record size";
+        return;
+    }
+
+    auto const body = data.size() - header_size;
+    if (body % this->record_size_ != 0) {
+        this->error_ = "truncated record";
+        return;
+    }
+    this->records_ = data.data() + header_size;
+    this->size_ = body / this->record_size_;
+}
+
+bool Reader::read(std::size_t index, Record &record) const {
+    auto const data = this->records_ + index * this->record_size_;
+    if (!decode(data, record)) {
+        return false;
+    }
+    record.timestamp =
+        this->has_timestamps() ? load<std::uint64_t>(data + 16) : 0;
+    return true;
+}
+
+}  // namespace ob::binary
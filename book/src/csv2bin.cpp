@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <fstream>
+#include <string_view>
+
+#include "binary_format.h"
+#include "mapped_file.h"
+#include "order_parser.h"
+#include "spdlog/spdlog.h"
+
+/** \brief Convert a CSV orders file to the binary format (see binary_format.h).
+ *
+ * Binary records have no symbol field, so the orders of a file must all be
+ * for the same symbol, or all have none: files mixing symbols are rejected
+ * rather than merged into a single book.
+ */
+int main(int ac, char** av) {
+    if (ac != 3) {
+        spdlog::error("Usage: {} orders_csv_path orders_bin_path", av[0]);
+        return 1;
+    }
+
+    ob::MappedFile input(av[1]);
+    if (!input) {
+        spdlog::error("Could not open file {}", av[1]);
+        return 1;
+    }
+
+    std::ofstream output(av[2], std::ios::binary);
+    if (!output) {
+        spdlog::error("Could not create file {}", av[2]);
+        return 1;
+    }
+
+    // The CSV format has no timestamps
+    ob::binary::Writer writer(output, false);
+    std::size_t converted = 0;
+    std::size_t errors = 0;
+    std::string_view symbol;  //!< Of the first valid line
+    ob::OrderReader reader(input.view());
+    for (ob::ParsedLine line; reader.next(line);) {
+        if (line.error != nullptr) {
+            spdlog::error("Invalid order at byte {} of {}: {}", line.offset,
+                          av[1], line.error);
+            ++errors;
+            continue;
+        }
+        if (converted == 0) {
+            symbol = line.symbol;
+        } else if (line.symbol != symbol) {
+            spdlog::error(
+                "Symbol '{}' at byte {} of {} differs from '{}': binary "
+                "files hold a single symbol",
+                line.symbol, line.offset, av[1], symbol);
+            output.close();
+            std::remove(av[2]);
+            return 1;
+        }
+        writer.write(line.type, line.order);
+        ++converted;
+    }
+
+    output.flush();
+    if (!output) {
+        spdlog::error("Could not write file {}", av[2]);
+        return 1;
+    }
+
+    spdlog::info("Converted {} orders ({} invalid lines skipped)", converted,
+                 errors);
+    return 0;
+}
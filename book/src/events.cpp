@@ -0,0 +1,44 @@
+#include "events.h"
+
+#include "logging.h"
+
+namespace ob {
+
+LogSink::LogSink(std::string_view symbol) : prefix(symbol) {
+    this->prefix += ": ";
+}
+
+void LogSink::on_trade(Trade const &trade) {
+    if (trade.resting_remaining > 0) {
+        OB_LOG_INFO(
+            "{}{} share(s) sold at {} (book order id={} partially filled, {} "
+            "remaining)",
+            this->prefix, trade.quantity, trade.price, trade.resting_id,
+            trade.resting_remaining);
+    } else {
+        OB_LOG_INFO("{}{} shares sold at {} (book order id={} fully filled)",
+                    this->prefix, trade.quantity, trade.price,
+                    trade.resting_id);
+    }
+}
+
+void LogSink::on_order_added(OrderAdded const &event) {
+    auto const &order = event.order;
+    OB_LOG_INFO("{}{} id={} quantity={} price={}", this->prefix,
+                order.side == OrderSide::BUY ? "Bid" : "Ask", order.id,
+                order.quantity, order.price);
+}
+
+void LogSink::on_order_cancelled(OrderCancelled const &event) {
+    auto const &order = event.order;
+    OB_LOG_INFO("{}Cancel id={} quantity={} price={}", this->prefix, order.id,
+                order.quantity, order.price);
+}
+
+void LogSink::on_order_reduced(OrderReduced const &event) {
+    auto const &order = event.order;
+    OB_LOG_DEBUG("{}Reduce id={} by={} quantity={} price={}", this->prefix,
+                 order.id, event.reduced_by, order.quantity, order.price);
+}
+
+}  // namespace ob
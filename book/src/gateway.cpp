@@ -0,0 +1,358 @@
+#include "gateway.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "binary_format.h"
+#include "little_endian.h"
+#include "spdlog/spdlog.h"
+
+namespace ob {
+
+namespace detail {
+
+void FillSink::on_trade(Trade const &trade) {
+    this->gateway->on_trade(trade);
+}
+
+}  // namespace detail
+
+Gateway::~Gateway() {
+    for (auto &connection : this->connections_) {
+        ::close(connection.second->fd);
+    }
+}
+
+bool Gateway::poll(int timeout_ms) {
+    constexpr int max_events = 256;
+    epoll_event events[max_events];
+
+    auto const count =
+        ::epoll_wait(this->epoll_, events, max_events, timeout_ms);
+    if (count < 0) {
+        if (errno != EINTR) {
+            spdlog::error("epoll_wait failed: {}", std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        auto const id = events[i].data.u64;
+        if (id == listener_id) {
+            this->accept_clients();
+            continue;
+        }
+        auto const found = this->connections_.find(id);
+        if (found == std::end(this->connections_)) {
+            continue;  // Closed earlier in this round
+        }
+        auto &connection = *found->second;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+            this->close(connection);
+            continue;
+        }
+        // A hang-up comes with EPOLLIN, and often EPOLLOUT: the connection
+        // is gone once read
+        if ((events[i].events & EPOLLIN) && !this->read_requests(connection)) {
+            continue;
+        }
+        if ((events[i].events & EPOLLOUT) && !connection.unsent.empty() &&
+            !connection.queued) {
+            connection.queued = true;
+            this->to_flush_.push_back(&connection);
+        }
+    }
+
+    // One writev per connection, for all the reports of the round
+    this->flushing_.swap(this->to_flush_);
+    for (auto connection : this->flushing_) {
+        connection->queued = false;
+        if (!this->flush(*connection)) {
+            this->close(*connection);
+        }
+    }
+    this->flushing_.clear();
+    return true;
+}
+
+void Gateway::accept_clients() {
+    for (;;) {
+        auto const fd = ::accept4(this->listener_, nullptr, nullptr,
+                                  SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                spdlog::error("accept failed: {}", std::strerror(errno));
+            }
+            return;
+        }
+
+        // Reports are batched by the gateway already
+        int const on = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        auto connection = std::make_unique<Connection>();
+        connection->id = this->next_id_++;
+        connection->fd = fd;
+        connection->input.resize(64 << 10);
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = connection->id;
+        if (::epoll_ctl(this->epoll_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            spdlog::error("epoll_ctl failed: {}", std::strerror(errno));
+            ::close(fd);
+            continue;
+        }
+        spdlog::debug("Client {} connected", connection->id);
+        this->connections_.emplace(connection->id, std::move(connection));
+        ++this->clients_;
+    }
+}
+
+bool Gateway::read_requests(Connection &connection) {
+    for (;;) {
+        // Make room: move the partial request left, or grow the buffer
+        if (connection.end == connection.input.size()) {
+            if (connection.begin > 0) {
+                std::memmove(connection.input.data(),
+                             connection.input.data() + connection.begin,
+                             connection.end - connection.begin);
+                connection.end -= connection.begin;
+                connection.begin = 0;
+            } else {
+                connection.input.resize(2 * connection.input.size());
+            }
+        }
+
+        auto const received =
+            ::read(connection.fd, connection.input.data() + connection.end,
+                   connection.input.size() - connection.end);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (received <= 0) {
+            this->close(connection);
+            return false;
+        }
+        connection.end += static_cast<std::size_t>(received);
+
+        // Requests are decoded straight from the buffer
+        while (connection.end - connection.begin >= wire::request_size) {
+            this->execute(connection,
+                          connection.input.data() + connection.begin);
+            connection.begin += wire::request_size;
+        }
+    }
+    if (connection.begin == connection.end) {
+        connection.begin = connection.end = 0;
+    }
+    return true;
+}
+
+void Gateway::execute(Connection &connection, char const *request) {
+    ++this->requests_;
+    binary::Record record{};
+    wire::Report ack{wire::ReportKind::REJECTED, OrderSide::BUY,
+                     detail::load<std::int32_t>(request + 4), 0, 0, 0, 0};
+    if (!binary::decode(request, record)) {
+        this->send(connection, ack);
+        return;
+    }
+
+    auto &order = record.order;
+    ack.side = order.side;
+    ack.price = order.price;
+    auto const mine = this->owners_.find(order.id);
+    auto const owned = mine != std::end(this->owners_) &&
+                       mine->second == connection.id;
+
+    // Since we use an enum, we would get a warning if our switch wasn't
+    // exhaustive
+    switch (record.type) {
+        case OrderType::NEW:
+            this->current_ = &connection;
+            this->incoming_left_ = order.quantity;
+            if (this->book_.place_order(order)) {
+                ack.kind = wire::ReportKind::ACCEPTED;
+            }
+            this->current_ = nullptr;
+            break;
+        case OrderType::CANCEL:
+            if (owned && this->book_.cancel(order.id)) {
+                ack.kind = wire::ReportKind::CANCELLED;
+            }
+            break;
+        case OrderType::MODIFY:
+            this->current_ = &connection;
+            this->incoming_left_ = order.quantity;
+            if (owned && this->book_.amend(order)) {
+                ack.kind = wire::ReportKind::AMENDED;
+            }
+            this->current_ = nullptr;
+            break;
+    }
+
+    // Keep track of who owns what rests, and report what does
+    auto const rests = this->book_.order_index.count(order.id) != 0;
+    if (ack.kind != wire::ReportKind::REJECTED) {
+        if (rests) {
+            this->owners_[order.id] = connection.id;
+            ack.quantity = order.quantity;
+        } else {
+            this->owners_.erase(order.id);
+        }
+    }
+    this->send(connection, ack);
+}
+
+void Gateway::on_trade(Trade const &trade) {
+    ++this->trades_;
+    auto const resting_side = trade.incoming_side == OrderSide::BUY
+                                  ? OrderSide::SELL
+                                  : OrderSide::BUY;
+
+    this->incoming_left_ -= trade.quantity;
+    if (this->current_ != nullptr) {
+        this->send(*this->current_,
+                   wire::Report{wire::ReportKind::FILL, trade.incoming_side,
+                                trade.incoming_id, trade.quantity, trade.price,
+                                trade.resting_id, this->incoming_left_});
+    }
+
+    if (auto const resting = this->owner(trade.resting_id)) {
+        this->send(*resting,
+                   wire::Report{wire::ReportKind::FILL, resting_side,
+                                trade.resting_id, trade.quantity, trade.price,
+                                trade.incoming_id, trade.resting_remaining});
+    }
+    if (trade.resting_remaining == 0) {
+        this->owners_.erase(trade.resting_id);
+    }
+}
+
+void Gateway::send(Connection &connection, wire::Report const &report) {
+    auto const size = connection.output.size();
+    connection.output.resize(size + wire::report_size);
+    wire::encode(connection.output.data() + size, report);
+    if (!connection.queued) {
+        connection.queued = true;
+        this->to_flush_.push_back(&connection);
+    }
+}
+
+bool Gateway::flush(Connection &connection) {
+    iovec buffers[2] = {
+        {connection.unsent.data(), connection.unsent.size()},
+        {connection.output.data(), connection.output.size()}};
+    auto const total = buffers[0].iov_len + buffers[1].iov_len;
+    if (total == 0) {
+        return true;
+    }
+
+    ssize_t written = -1;
+    do {
+        written = ::writev(connection.fd, buffers, 2);
+    } while (written < 0 && errno == EINTR);
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return false;
+        }
+        written = 0;
+    }
+
+    // Keep what was not taken, in order, until the next EPOLLOUT
+    auto sent = static_cast<std::size_t>(written);
+    if (sent < connection.unsent.size()) {
+        connection.unsent.erase(
+            std::begin(connection.unsent),
+            std::begin(connection.unsent) + static_cast<std::ptrdiff_t>(sent));
+        connection.unsent.insert(std::end(connection.unsent),
+                                 std::begin(connection.output),
+                                 std::end(connection.output));
+    } else {
+        sent -= connection.unsent.size();
+        connection.unsent.assign(
+            std::begin(connection.output) + static_cast<std::ptrdiff_t>(sent),
+            std::end(connection.output));
+    }
+    connection.output.clear();
+
+    if (connection.unsent.size() > max_unsent) {
+        spdlog::warn("Client {} does not read its reports, dropping it",
+                     connection.id);
+        return false;
+    }
+    return true;
+}
+
+void Gateway::close(Connection &connection) {
+    spdlog::debug("Client {} disconnected", connection.id);
+    ::epoll_ctl(this->epoll_, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    if (this->current_ == &connection) {
+        this->current_ = nullptr;
+    }
+    this->to_flush_.erase(std::remove(std::begin(this->to_flush_),
+                                      std::end(this->to_flush_), &connection),
+                          std::end(this->to_flush_));
+    this->connections_.erase(connection.id);
+}
+
+Gateway::Connection *Gateway::owner(OrderId id) const {
+    auto const found = this->owners_.find(id);
+    if (found == std::end(this->owners_)) {
+        return nullptr;
+    }
+    auto const connection = this->connections_.find(found->second);
+    return connection == std::end(this->connections_)
+               ? nullptr
+               : connection->second.get();
+}
+
+void Gateway::show_summary() const {
+    spdlog::info("Served {} clients: {} requests, {} trades", this->clients_,
+                 this->requests_, this->trades_);
+    spdlog::info("Final order book:");
+    this->book_.show_bids(spdlog::level::info);
+    this->book_.show_asks(spdlog::level::info);
+}
+
+int listen_on(std::uint16_t port) {
+    auto const fd =
+        ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int const on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) <
+            0 ||
+        ::listen(fd, SOMAXCONN) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+}  // namespace ob
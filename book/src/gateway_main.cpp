@@ -0,0 +1,77 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include "gateway.h"
+#include "logging.h"
+#include "spdlog/spdlog.h"
+
+//! Local helper functions
+namespace {
+
+//! Set by SIGINT and SIGTERM, checked between two rounds of events.
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) { stop_requested = 1; }
+
+}  // namespace
+
+//! Accept orders from TCP clients on a loopback port (see wire.h).
+int main(int ac, char **av) {
+    ob::init_logging();
+
+    std::uint16_t port = 9000;
+    if (ac == 3 && std::string_view(av[1]) == "--port") {
+        port = static_cast<std::uint16_t>(std::strtoul(av[2], nullptr, 10));
+    } else if (ac != 1) {
+        spdlog::error("Usage: {} [--port N]", av[0]);
+        return 1;
+    }
+
+    auto const listener = ob::listen_on(port);
+    if (listener < 0) {
+        spdlog::error("Could not listen on port {}: {}", port,
+                      std::strerror(errno));
+        return 1;
+    }
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length);
+
+    auto const epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = 0;
+    if (epoll < 0 ||
+        ::epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) < 0) {
+        spdlog::error("Could not set up epoll: {}", std::strerror(errno));
+        return 1;
+    }
+
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    spdlog::info("Listening on 127.0.0.1:{}", ntohs(address.sin_port));
+    {
+        ob::Gateway gateway(listener, epoll);
+        while (stop_requested == 0 && gateway.poll(-1)) {
+            // One round of events per turn, until a signal or an error
+        }
+        gateway.show_summary();
+    }
+    ::close(epoll);
+    ::close(listener);
+
+    ob::shutdown_logging();
+    return 0;
+}
@@ -0,0 +1,378 @@
+#include "journal.h"
+
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <share.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "little_endian.h"
+#include "mapped_file.h"
+#include "spdlog/spdlog.h"
+
+//! Local helper functions
+namespace {
+
+using ob::detail::load;
+using ob::detail::store;
+
+//! 32-bit FNV-1a hash of the start of an entry.
+std::uint32_t fnv1a(char const *data, std::size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr std::size_t hashed_size = ob::journal::entry_size - 4;
+
+void encode(char *entry, std::uint64_t sequence, ob::OrderType type,
+            ob::Order const &order) {
+    std::fill(entry, entry + ob::journal::entry_size, '\0');
+    store<std::uint64_t>(entry, sequence);
+    entry[8] = ob::OrderTypeToChar(type);
+    entry[9] = order.side == ob::OrderSide::BUY ? 'B' : 'S';
+    entry[10] = static_cast<char>(order.time_in_force);
+    store<std::int32_t>(entry + 12, order.id);
+    store<std::int32_t>(entry + 16, order.quantity);
+    store<std::int32_t>(entry + 20, order.price);
+    store<std::uint32_t>(entry + hashed_size, fnv1a(entry, hashed_size));
+}
+
+//! Whether an entry is complete, intact, and where it should be.
+bool valid(char const *entry, std::uint64_t sequence) {
+    return load<std::uint32_t>(entry + hashed_size) ==
+               fnv1a(entry, hashed_size) &&
+           load<std::uint64_t>(entry) == sequence &&
+           ob::StringToOrderType.count(std::string_view(entry + 8, 1)) &&
+           (entry[9] == 'B' || entry[9] == 'S') &&
+           ob::detail::valid_time_in_force(entry[10]);
+}
+
+/**
+ * File operations, with the sync primitive of each platform
+ */
+
+#if defined(_WIN32)
+
+int open_file(std::string const &path) {
+    int fd = -1;
+    _sopen_s(&fd, path.c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _SH_DENYNO,
+             _S_IREAD | _S_IWRITE);
+    return fd;
+}
+
+bool write_all(int fd, char const *data, std::size_t size) {
+    while (size > 0) {
+        auto const written =
+            _write(fd, data, static_cast<unsigned>(std::min<std::size_t>(
+                                 size, 1u << 30)));
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool sync_file(int fd) { return _commit(fd) == 0; }
+
+bool resize_file(int fd, std::size_t size) {
+    return _chsize_s(fd, static_cast<__int64>(size)) == 0 &&
+           _lseeki64(fd, 0, SEEK_END) >= 0;
+}
+
+void close_file(int fd) { _close(fd); }
+
+#else
+
+int open_file(std::string const &path) {
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+}
+
+bool write_all(int fd, char const *data, std::size_t size) {
+    while (size > 0) {
+        auto const written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool sync_file(int fd) {
+#if defined(__linux__)
+    // The size of the file changes, so the metadata is synced too
+    return ::fdatasync(fd) == 0;
+#else
+    return ::fsync(fd) == 0;
+#endif
+}
+
+bool resize_file(int fd, std::size_t size) {
+    return ::ftruncate(fd, static_cast<off_t>(size)) == 0 &&
+           ::lseek(fd, 0, SEEK_END) >= 0;
+}
+
+void close_file(int fd) { ::close(fd); }
+
+#endif
+
+}  // namespace
+
+namespace ob::journal {
+
+bool has_magic(std::string_view data) {
+    return data.size() >= sizeof(magic) &&
+           std::equal(std::begin(magic), std::end(magic), data.data());
+}
+
+Reader::Reader(std::string_view data) {
+    if (data.size() < header_size || !has_magic(data)) {
+        this->error_ = "not a journal";
+        return;
+    }
+    if (load<std::uint16_t>(data.data() + 8) != version) {
+        this->error_ = "unsupported version";
+        return;
+    }
+
+    this->entries_ = data.data() + header_size;
+    auto const complete = (data.size() - header_size) / entry_size;
+    while (this->size_ < complete &&
+           valid(this->entries_ + this->size_ * entry_size,
+                 this->size_ + 1)) {
+        ++this->size_;
+    }
+    this->torn_ = offset(this->size_) != data.size();
+}
+
+Entry Reader::read(std::size_t index) const {
+    auto const data = this->entries_ + index * entry_size;
+    Entry entry;
+    entry.sequence = load<std::uint64_t>(data);
+    entry.type = StringToOrderType.find(std::string_view(data + 8, 1))->second;
+    entry.order.side = data[9] == 'B' ? OrderSide::BUY : OrderSide::SELL;
+    entry.order.time_in_force = static_cast<TimeInForce>(data[10]);
+    entry.order.id = load<std::int32_t>(data + 12);
+    entry.order.quantity = load<std::int32_t>(data + 16);
+    entry.order.price = load<std::int32_t>(data + 20);
+    return entry;
+}
+
+Writer::Writer(std::string const &path, WriterConfig const &config)
+    : config_(config) {
+    // Continue an existing journal, without its torn end
+    std::size_t keep = 0;
+    {
+        MappedFile existing(path);
+        if (existing && !existing.view().empty()) {
+            Reader reader(existing.view());
+            if (reader.error() != nullptr) {
+                spdlog::error("Cannot append to {}: {}", path, reader.error());
+                return;
+            }
+            if (reader.torn()) {
+                spdlog::warn("Dropping the torn end of {} after entry {}",
+                             path, reader.size());
+            }
+            this->appended_ = reader.size();
+            keep = Reader::offset(reader.size());
+        }
+    }
+
+    this->fd_ = open_file(path);
+    if (this->fd_ < 0) {
+        return;
+    }
+    auto ok = resize_file(this->fd_, keep);
+    if (ok && keep == 0) {
+        char header[header_size] = {};
+        std::copy(std::begin(magic), std::end(magic), header);
+        store<std::uint16_t>(header + 8, version);
+        ok = write_all(this->fd_, header, header_size) && sync_file(this->fd_);
+    }
+    if (!ok) {
+        close_file(this->fd_);
+        this->fd_ = -1;
+        return;
+    }
+
+    this->durable_.store(this->appended_, std::memory_order_release);
+    if (this->config_.group_commit) {
+        this->buffer_.reserve(this->config_.batch_size * entry_size);
+        this->flusher_ = std::thread([this] { this->run(); });
+    }
+}
+
+Writer::~Writer() {
+    if (this->flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->stopping_ = true;
+        }
+        this->wake_.notify_one();
+        this->flusher_.join();
+    }
+    if (this->fd_ >= 0) {
+        close_file(this->fd_);
+    }
+}
+
+std::uint64_t Writer::append(OrderType type, Order const &order) {
+    if (!this->config_.group_commit) {
+        // One write and one sync per entry, none after a failure
+        auto const start = Clock::now();
+        auto const sequence = ++this->appended_;
+        if (this->failed()) {
+            return sequence;
+        }
+        char entry[entry_size];
+        encode(entry, sequence, type, order);
+        if (this->write_and_sync(entry, entry_size)) {
+            auto const commit = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start)
+                    .count());
+            ++this->stats_.syncs;
+            ++this->stats_.entries;
+            this->stats_.total_commit_ns += commit;
+            this->stats_.max_commit_ns =
+                std::max(this->stats_.max_commit_ns, commit);
+            this->durable_.store(sequence, std::memory_order_release);
+        } else {
+            this->failed_.store(true, std::memory_order_release);
+        }
+        return sequence;
+    }
+
+    std::uint64_t sequence;
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        sequence = ++this->appended_;
+        if (this->failed()) {
+            // The flusher is gone, nothing would write the entry
+            return sequence;
+        }
+        auto const size = this->buffer_.size();
+        this->buffer_.resize(size + entry_size);
+        encode(this->buffer_.data() + size, sequence, type, order);
+
+        // The flusher waits for the first entry, then for a full batch
+        if (size == 0) {
+            this->oldest_ = Clock::now();
+        }
+        wake = size == 0 ||
+               this->buffer_.size() >= this->config_.batch_size * entry_size;
+    }
+    if (wake) {
+        this->wake_.notify_one();
+    }
+    return sequence;
+}
+
+void Writer::wait_durable(std::uint64_t sequence) {
+    if (this->durable() >= sequence || !this->config_.group_commit) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->flushed_.wait(lock, [this, sequence] {
+        return this->durable() >= sequence || this->failed();
+    });
+}
+
+bool Writer::sync() {
+    if (!this->config_.group_commit) {
+        return !this->failed();
+    }
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    auto const sequence = this->appended_;
+    this->sync_requested_ = true;
+    this->wake_.notify_one();
+    this->flushed_.wait(lock, [this, sequence] {
+        return this->durable() >= sequence || this->failed();
+    });
+    return !this->failed();
+}
+
+bool Writer::write_and_sync(char const *data, std::size_t size) {
+    if (write_all(this->fd_, data, size) && sync_file(this->fd_)) {
+        return true;
+    }
+    spdlog::error("Could not write to the journal");
+    return false;
+}
+
+void Writer::run() {
+    // Swapped with the buffer, so both keep their capacity
+    std::vector<char> batch;
+    batch.reserve(this->buffer_.capacity());
+
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    for (;;) {
+        this->wake_.wait(lock, [this] {
+            return this->stopping_ || !this->buffer_.empty();
+        });
+        if (this->buffer_.empty()) {
+            return;
+        }
+
+        // Give the batch a chance to fill up, but not for too long
+        this->wake_.wait_until(
+            lock, this->oldest_ + this->config_.max_delay, [this] {
+                return this->stopping_ || this->sync_requested_ ||
+                       this->buffer_.size() >=
+                           this->config_.batch_size * entry_size;
+            });
+        batch.swap(this->buffer_);
+        auto const sequence = this->appended_;
+        auto const oldest = this->oldest_;
+        this->sync_requested_ = false;
+        lock.unlock();
+
+        auto const ok = this->write_and_sync(batch.data(), batch.size());
+        auto const commit = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                                 oldest)
+                .count());
+        if (ok) {
+            ++this->stats_.syncs;
+            this->stats_.entries += batch.size() / entry_size;
+            this->stats_.total_commit_ns += commit;
+            this->stats_.max_commit_ns =
+                std::max(this->stats_.max_commit_ns, commit);
+        }
+        batch.clear();
+
+        lock.lock();
+        if (!ok) {
+            // The batch may be partly on disk: writing the next ones would
+            // leave a gap, so the journal stops here and every waiter gives up
+            this->failed_.store(true, std::memory_order_release);
+            this->buffer_.clear();
+            this->flushed_.notify_all();
+            return;
+        }
+        this->durable_.store(sequence, std::memory_order_release);
+        this->flushed_.notify_all();
+    }
+}
+
+}  // namespace ob::journal
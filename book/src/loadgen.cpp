@@ -0,0 +1,262 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "binary_format.h"
+#include "book_stats.h"
+#include "logging.h"
+#include "spdlog/spdlog.h"
+#include "wire.h"
+
+//! Local helper functions
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//! Command line of the load generator.
+struct Options final {
+    std::uint16_t port = 9000;
+    std::size_t connections = 4;  //!< One thread each
+    std::size_t orders = 100000;  //!< Requests sent by each connection
+    std::size_t window = 64;      //!< Requests in flight per connection
+    //! Of the first order. IDs must not be reused while the gateway runs.
+    std::size_t first_id = 1;
+};
+
+//! What one connection measured.
+struct Result final {
+    bool ok = false;
+    std::size_t acks = 0;
+    std::size_t rejects = 0;
+    std::size_t fills = 0;
+    ob::LatencyHistogram round_trip;  //!< From write to acknowledgement
+};
+
+//! Connect to the gateway on the loopback interface, or return -1.
+int connect_to(std::uint16_t port) {
+    auto const fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    int const on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    return fd;
+}
+
+//! Write a whole buffer to a blocking socket.
+bool write_all(int fd, char const *data, std::size_t size) {
+    while (size > 0) {
+        auto const written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/** \brief Send orders over one connection, keeping `window` in flight.
+ *
+ * Buys and sells around a price of 1000, a tenth of them IOC, so that some
+ * trade and the book does not only grow. Each connection uses its own range
+ * of order IDs, after `options.first_id`.
+ */
+Result run_client(Options const &options, std::size_t client) {
+    Result result;
+    auto const fd = connect_to(options.port);
+    if (fd < 0) {
+        spdlog::error("Could not connect to port {}: {}", options.port,
+                      std::strerror(errno));
+        return result;
+    }
+
+    auto const first_id =
+        static_cast<ob::OrderId>(options.first_id + client * options.orders);
+    std::uint64_t random = 0x9e3779b97f4a7c15ULL * (client + 1);
+    std::deque<Clock::time_point> in_flight;  //!< Send times, oldest first
+    std::vector<char> requests;
+    std::vector<char> input(64 << 10);
+    std::size_t buffered = 0;
+    std::size_t sent = 0;
+
+    while (result.acks < options.orders) {
+        // Top the window up, in a single write
+        requests.clear();
+        while (sent < options.orders &&
+               in_flight.size() + requests.size() / ob::wire::request_size <
+                   options.window) {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+            auto const bits = random >> 33;
+            auto const side =
+                bits & 1 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+            auto const time_in_force = (bits >> 12) % 10 == 0
+                                           ? ob::TimeInForce::IOC
+                                           : ob::TimeInForce::GTC;
+            ob::Order order{first_id + static_cast<ob::OrderId>(sent++), side,
+                            static_cast<ob::Quantity>(1 + (bits >> 1) % 100),
+                            static_cast<ob::Price>(995 + (bits >> 8) % 11),
+                            time_in_force};
+            requests.resize(requests.size() + ob::wire::request_size);
+            ob::binary::encode(
+                requests.data() + requests.size() - ob::wire::request_size,
+                ob::OrderType::NEW, order);
+        }
+        if (!requests.empty()) {
+            auto const now = Clock::now();
+            in_flight.insert(std::end(in_flight),
+                             requests.size() / ob::wire::request_size, now);
+            if (!write_all(fd, requests.data(), requests.size())) {
+                spdlog::error("Connection {} lost", client);
+                ::close(fd);
+                return result;
+            }
+        }
+
+        // Read whatever reports are there
+        auto const received = ::read(fd, input.data() + buffered,
+                                     input.size() - buffered);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            spdlog::error("Connection {} lost", client);
+            ::close(fd);
+            return result;
+        }
+        buffered += static_cast<std::size_t>(received);
+        auto const now = Clock::now();
+
+        std::size_t offset = 0;
+        for (; buffered - offset >= ob::wire::report_size;
+             offset += ob::wire::report_size) {
+            ob::wire::Report report{};
+            if (!ob::wire::decode(input.data() + offset, report)) {
+                spdlog::error("Invalid report on connection {}", client);
+                ::close(fd);
+                return result;
+            }
+            if (report.kind == ob::wire::ReportKind::FILL) {
+                ++result.fills;
+                continue;
+            }
+            // Acknowledgements come in the order of the requests
+            if (report.kind == ob::wire::ReportKind::REJECTED) {
+                ++result.rejects;
+            }
+            result.round_trip.record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    now - in_flight.front())
+                    .count()));
+            in_flight.pop_front();
+            ++result.acks;
+        }
+        std::memmove(input.data(), input.data() + offset, buffered - offset);
+        buffered -= offset;
+    }
+
+    ::close(fd);
+    result.ok = true;
+    return result;
+}
+
+}  // namespace
+
+//! Measure the round trips and the throughput of the gateway.
+int main(int ac, char **av) {
+    ob::init_logging();
+
+    Options options;
+    auto valid = true;
+    for (int i = 1; i + 1 < ac && valid; i += 2) {
+        std::string_view arg(av[i]);
+        auto const value = std::strtoul(av[i + 1], nullptr, 10);
+        if (arg == "--port") {
+            options.port = static_cast<std::uint16_t>(value);
+        } else if (arg == "--connections") {
+            options.connections = value;
+        } else if (arg == "--orders") {
+            options.orders = value;
+        } else if (arg == "--window") {
+            options.window = value;
+        } else if (arg == "--first-id") {
+            options.first_id = value;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || ac % 2 == 0 || options.connections == 0 ||
+        options.window == 0 ||
+        options.first_id + options.connections * options.orders > INT32_MAX) {
+        spdlog::error(
+            "Usage: {} [--port N] [--connections N] [--orders N] "
+            "[--window N] [--first-id N]",
+            av[0]);
+        return 1;
+    }
+
+    std::vector<Result> results(options.connections);
+    auto const start = Clock::now();
+    {
+        std::vector<std::thread> clients;
+        for (std::size_t i = 0; i < options.connections; ++i) {
+            clients.emplace_back([&options, &results, i] {
+                results[i] = run_client(options, i);
+            });
+        }
+        for (auto &client : clients) {
+            client.join();
+        }
+    }
+    auto const elapsed =
+        std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result total;
+    total.ok = true;
+    for (auto const &result : results) {
+        total.ok = total.ok && result.ok;
+        total.acks += result.acks;
+        total.rejects += result.rejects;
+        total.fills += result.fills;
+        total.round_trip.merge(result.round_trip);
+    }
+
+    auto const &latency = total.round_trip;
+    spdlog::info(
+        "{} requests over {} connections in {:.3f} s: {:.0f} requests/s, {} "
+        "rejected, {} fills",
+        total.acks, options.connections, elapsed,
+        static_cast<double>(total.acks) / elapsed, total.rejects, total.fills);
+    spdlog::info(
+        "Round trip: p50 {} ns, p99 {} ns, p99.9 {} ns, max {} ns "
+        "(window of {})",
+        latency.percentile(0.5), latency.percentile(0.99),
+        latency.percentile(0.999), latency.max(), options.window);
+
+    ob::shutdown_logging();
+    return total.ok ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+#include "logging.h"
+
+#if defined(OB_ASYNC_LOGS)
+#include <memory>
+#include <utility>
+
+#include "spdlog/async.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+#endif
+
+namespace ob {
+
+void init_logging() {
+#if defined(OB_ASYNC_LOGS)
+    spdlog::init_thread_pool(async_log_queue_size, 1);
+    auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    auto logger = std::make_shared<spdlog::async_logger>(
+        "", std::move(sink), spdlog::thread_pool(),
+        spdlog::async_overflow_policy::overrun_oldest);
+    logger->set_level(spdlog::default_logger_raw()->level());
+    spdlog::set_default_logger(logger);
+#endif
+}
+
+void shutdown_logging() {
+    spdlog::default_logger_raw()->flush();
+    spdlog::shutdown();
+}
+
+}  // namespace ob
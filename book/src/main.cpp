@@ -1,47 +1,617 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "binary_format.h"
+#include "book_manager.h"
+#include "journal.h"
+#include "logging.h"
+#include "mapped_file.h"
 #include "order_book.h"
+#include "order_parser.h"
+#include "parallel_reader.h"
+#include "pipeline.h"
+#include "snapshot.h"
 #include "spdlog/spdlog.h"
+#include "work_pool.h"
 
-int main(int ac, char** av) {
-    if (ac != 2) {
-        spdlog::error("Usage: {} orders_file_path", av[0]);
-        return 1;
+//! Local helper functions
+namespace {
+
+//! Command line of main.
+struct Options final {
+    std::string file_path;      //!< Orders to process
+    //! Replay these files, each in its own book, instead of file_path
+    std::vector<std::string> replay;
+    std::size_t threads = 0;  //!< Replay threads, 0 for one per core
+    //! Threads parsing CSV files ahead of matching, 0 to parse as we match
+    std::size_t parse_threads = 0;
+    std::size_t shards = 0;     //!< Worker threads, 0 for a single book
+    bool pipeline = false;      //!< Match and log on their own threads
+    std::string snapshot;       //!< Snapshot to start from, if any
+    std::string save_snapshot;  //!< Where to save the final book, if any
+    std::string journal;        //!< Where to journal the orders, if any
+    //! First journal entry to replay, when reading a journal
+    std::uint64_t replay_from = 1;
+    //! Last journal entry to replay, when reading a journal
+    std::uint64_t replay_until = UINT64_MAX;
+    bool stats = false;  //!< Measure the latency of every operation
+    //! Messages collected by the opening call auction, 0 for none
+    std::size_t auction = 0;
+};
+
+/** \brief Call `on_order(symbol, type, order)` for every order of a CSV,
+ *         binary or journal file, as they are read.
+ *
+ * Binary files and journals have no symbol field, their orders all have an
+ * empty symbol. Journals are replayed from `options.replay_from` up to
+ * `options.replay_until`.
+ *
+ * \return false if the file cannot be read at all.
+ */
+template <typename OnOrder>
+bool read_orders(ob::MappedFile& file, Options const& options,
+                 OnOrder&& on_order) {
+    auto const& file_path = options.file_path;
+
+    // The part of the file already processed is given back to the system as
+    // we go
+    constexpr std::size_t discard_every = 64 << 20;
+    std::size_t discarded = 0;
+    auto release = [&](std::size_t offset) {
+        if (offset - discarded >= discard_every) {
+            discarded = offset;
+            file.discard(discarded);
+        }
+    };
+
+    if (ob::journal::has_magic(file.view())) {
+        // Recovery: replay what survived, possibly from and up to given
+        // entries. Entries are numbered from 1 without gaps.
+        ob::journal::Reader reader(file.view());
+        if (reader.error() != nullptr) {
+            spdlog::error("Could not read {}: {}", file_path, reader.error());
+            return false;
+        }
+        if (reader.torn()) {
+            spdlog::warn("{} ends with a torn entry after entry {}", file_path,
+                         reader.size());
+        }
+
+        auto const first = std::max<std::uint64_t>(options.replay_from, 1);
+        for (auto i = first - 1; i < reader.size(); ++i) {
+            auto entry = reader.read(i);
+            if (entry.sequence > options.replay_until) {
+                break;
+            }
+            on_order(std::string_view(), entry.type, entry.order);
+            release(ob::journal::Reader::offset(i));
+        }
+    } else if (ob::binary::has_magic(file.view())) {
+        // Binary replay: fixed-size records, nothing to parse
+        ob::binary::Reader reader(file.view());
+        if (reader.error() != nullptr) {
+            spdlog::error("Could not read {}: {}", file_path, reader.error());
+            return false;
+        }
+
+        ob::binary::Record record;
+        for (std::size_t i = 0; i < reader.size(); ++i) {
+            if (!reader.read(i, record)) {
+                spdlog::error("Invalid record at byte {} of {}",
+                              reader.offset(i), file_path);
+                continue;
+            }
+            on_order(std::string_view(), record.type, record.order);
+            release(reader.offset(i));
+        }
+    } else {
+        auto on_line = [&](ob::ParsedLine &line) {
+            if (line.error != nullptr) {
+                spdlog::error("Invalid order at byte {} of {}: {}",
+                              line.offset, file_path, line.error);
+            } else {
+                on_order(line.symbol, line.type, line.order);
+            }
+        };
+
+        if (options.parse_threads > 0) {
+            // Parsing runs ahead on other threads, matching stays here
+            ob::ParallelOrderReader reader(file.view(),
+                                           options.parse_threads);
+            while (auto const batch = reader.next()) {
+                for (auto line : *batch) {
+                    on_line(line);
+                }
+                release(reader.offset());
+            }
+        } else {
+            ob::OrderReader reader(file.view());
+            for (ob::ParsedLine line; reader.next(line);) {
+                on_line(line);
+                release(reader.offset());
+            }
+        }
     }
+    return true;
+}
 
-    std::string file_path(av[1]);
+//! Log the percentiles of one operation's latencies.
+void log_latency(char const* name, ob::LatencyHistogram const& histogram) {
+    spdlog::info(
+        "{} latency over {} calls: p50 {} ns, p99 {} ns, p99.9 {} ns, max {} "
+        "ns",
+        name, histogram.count(), histogram.percentile(0.5),
+        histogram.percentile(0.99), histogram.percentile(0.999),
+        histogram.max());
+}
 
-    spdlog::debug("Opening file {}", file_path);
-    std::ifstream file_stream(file_path);
-    if (!file_stream) {
-        spdlog::error("Could not open file {}", file_path);
-        return 1;
+/** \brief Match every order in a single book, logging every event.
+ *
+ * The book can start from a snapshot, so that the file only needs to hold the
+ * orders received after it. Orders can be journaled before being matched.
+ * Snapshots record the last journal entry in the book, and a journal
+ * replayed over a snapshot starts after it.
+ *
+ * With BookStats, the latencies of the book's operations are logged at the
+ * end. With NullStats, nothing is measured.
+ */
+template <typename Stats>
+int run_single(ob::MappedFile& file, Options const& options) {
+    // Log every event, like the book used to do by itself
+    ob::OrderBook<ob::MapBackend, ob::LogSink, Stats> order_book;
+    std::size_t processed = 0;
+    std::uint64_t journaled = 0;  //!< Last journal entry in the book
+    auto recovery = options;
+
+    if (!options.snapshot.empty()) {
+        ob::MappedFile snapshot(options.snapshot);
+        if (!snapshot) {
+            spdlog::error("Could not open snapshot {}", options.snapshot);
+            return 1;
+        }
+        if (!order_book.load_snapshot(snapshot.view())) {
+            return 1;
+        }
+        journaled = ob::snapshot::Reader(snapshot.view()).journal();
+        spdlog::debug("Loaded {} orders from {}, up to journal entry {}",
+                      order_book.order_index.size(), options.snapshot,
+                      journaled);
     }
+    // The entries already in the book are never replayed twice
+    recovery.replay_from = std::max(options.replay_from, journaled + 1);
 
-    spdlog::debug("Load orders from file", file_path);
-    auto orders = ob::read_orders_file(file_stream);
-    spdlog::debug("Loaded {} orders", orders.size());
+    // The first messages are collected, then executed at a single price
+    auto uncross = [&order_book]() {
+        auto const result = order_book.uncross();
+        spdlog::info("Opening auction: {} traded at {}", result.volume,
+                     result.price);
+    };
+    if (options.auction > 0) {
+        order_book.open_auction();
+    }
 
-    ob::OrderBook order_book;
+    std::unique_ptr<ob::journal::Writer> journal;
+    if (!options.journal.empty()) {
+        journal = std::make_unique<ob::journal::Writer>(options.journal);
+        if (!*journal) {
+            spdlog::error("Could not open journal {}", options.journal);
+            return 1;
+        }
+    }
 
-    for (auto& type_and_order : orders) {
-        auto& order = type_and_order.second;
+    auto process = [&](std::string_view, ob::OrderType type,
+                       ob::Order& order) {
+        // Write-ahead: a gateway would hold the acknowledgement until
+        // journal->durable() reaches the returned sequence number
+        if (journal) {
+            journaled = journal->append(type, order);
+        }
 
-        switch (type_and_order.first) {
+        switch (type) {
             case ob::OrderType::NEW:
                 order_book.place_order(order);
                 break;
             case ob::OrderType::CANCEL:
                 order_book.cancel(order);
                 break;
+            case ob::OrderType::MODIFY:
+                order_book.amend(order);
+                break;
+        }
+        if (++processed == options.auction) {
+            uncross();
         }
 
-        spdlog::debug("Order book is now:");
-        order_book.show_bids();
-        order_book.show_asks();
+        // Walking the whole book after every order is only worth it when
+        // someone reads the output
+        if constexpr (ob::hot_path_logs) {
+            if (spdlog::default_logger_raw()->should_log(
+                    spdlog::level::debug)) {
+                spdlog::debug("Order book is now:");
+                order_book.show_bids();
+                order_book.show_asks();
+            }
+        }
+    };
+
+    if (!read_orders(file, recovery, process)) {
+        return 1;
+    }
+    if (!journal && processed > 0 && ob::journal::has_magic(file.view())) {
+        // Replayed from a journal: the entries read have no gaps
+        journaled = recovery.replay_from - 1 + processed;
+    }
+    if (order_book.in_auction()) {
+        uncross();
+    }
+    if (journal && !journal->sync()) {
+        spdlog::error("Could not write journal {}", options.journal);
+        return 1;
+    }
+    spdlog::debug("Processed {} orders", processed);
+
+    if constexpr (Stats::enabled) {
+        log_latency("place_order", order_book.stats.place);
+        log_latency("cancel", order_book.stats.cancel);
+        log_latency("amend", order_book.stats.amend);
+        spdlog::info("{} levels swept, {} resting orders filled",
+                     order_book.stats.levels_swept,
+                     order_book.stats.orders_filled);
     }
 
     spdlog::info("Final order book:");
     order_book.show_bids(spdlog::level::info);
     order_book.show_asks(spdlog::level::info);
 
+    if (!options.save_snapshot.empty()) {
+        std::ofstream snapshot(options.save_snapshot, std::ios::binary);
+        order_book.save_snapshot(snapshot, journaled);
+        if (!snapshot) {
+            spdlog::error("Could not write snapshot {}",
+                          options.save_snapshot);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** \brief Match the orders of each symbol in its own book, over worker
+ *         threads.
+ *
+ * Every event is logged, like in a single book, after the symbol of its
+ * book. The events of different symbols are interleaved.
+ */
+int run_sharded(ob::MappedFile& file, Options const& options) {
+    ob::ManagerConfig config;
+    config.shards = options.shards;
+    ob::BookManager<ob::MapBackend, ob::LogSink> manager(config);
+    std::size_t processed = 0;
+
+    auto submit = [&](std::string_view symbol, ob::OrderType type,
+                      ob::Order& order) {
+        manager.submit(symbol, type, order);
+        ++processed;
+    };
+
+    auto const ok = read_orders(file, options, submit);
+    manager.stop();
+    if (!ok) {
+        return 1;
+    }
+    spdlog::debug("Processed {} orders for {} symbols on {} threads",
+                  processed, manager.symbol_count(), manager.shard_count());
+
+    manager.for_each_book([](std::string const& symbol, auto const& book) {
+        spdlog::info("Final order book for {}:", symbol);
+        book.show_bids(spdlog::level::info);
+        book.show_asks(spdlog::level::info);
+    });
     return 0;
-}
\ No newline at end of file
+}
+
+//! Parse on this thread, match and log the events on two other threads.
+int run_pipeline(ob::MappedFile& file, Options const& options) {
+    ob::Pipeline<ob::MapBackend, ob::LogSink> pipeline;
+
+    auto const ok = read_orders(
+        file, options,
+        [&pipeline](std::string_view, ob::OrderType type, ob::Order& order) {
+            pipeline.submit(type, order);
+        });
+    pipeline.stop();
+    if (!ok) {
+        return 1;
+    }
+
+    auto const& latency = pipeline.latency();
+    spdlog::info("Queue latency: mean {:.0f} ns, max {} ns over {} orders",
+                 latency.mean_ns(), latency.max_ns, latency.count);
+
+    spdlog::info("Final order book:");
+    pipeline.book().show_bids(spdlog::level::info);
+    pipeline.book().show_asks(spdlog::level::info);
+    return 0;
+}
+
+//! Event sink counting the trades of a replayed file.
+struct TradeCounter final {
+    std::size_t trades = 0;
+    std::int64_t volume = 0;
+
+    void on_trade(ob::Trade const &trade) {
+        ++this->trades;
+        this->volume += trade.quantity;
+    }
+    void on_order_added(ob::OrderAdded const &) {}
+    void on_order_cancelled(ob::OrderCancelled const &) {}
+    void on_order_reduced(ob::OrderReduced const &) {}
+};
+
+//! What replaying one file gave.
+struct ReplaySummary final {
+    bool ok = false;  //!< Whether the file could be read
+    std::size_t orders = 0;
+    std::size_t trades = 0;
+    std::int64_t volume = 0;
+    std::vector<ob::DepthLevel> bids;  //!< Final book, best level first
+    std::vector<ob::DepthLevel> asks;  //!< Final book, best level first
+    double seconds = 0;                //!< Time spent on the file
+};
+
+//! Match every order of a file in a book of its own.
+ReplaySummary replay_file(Options options, std::string const &file_path) {
+    auto const start = std::chrono::steady_clock::now();
+    ReplaySummary summary;
+    options.file_path = file_path;
+    ob::MappedFile file(file_path);
+    if (!file) {
+        spdlog::error("Could not open file {}", file_path);
+        return summary;
+    }
+
+    ob::OrderBook<ob::MapBackend, TradeCounter> order_book;
+    summary.ok = read_orders(
+        file, options,
+        [&](std::string_view, ob::OrderType type, ob::Order &order) {
+            // Since we use an enum, we would get a warning if our switch
+            // wasn't exhaustive
+            switch (type) {
+                case ob::OrderType::NEW:
+                    order_book.place_order(order);
+                    break;
+                case ob::OrderType::CANCEL:
+                    order_book.cancel(order);
+                    break;
+                case ob::OrderType::MODIFY:
+                    order_book.amend(order);
+                    break;
+            }
+            ++summary.orders;
+        });
+
+    // There are never more levels than resting orders
+    auto const resting = order_book.order_index.size();
+    summary.bids.resize(resting);
+    summary.bids.resize(
+        order_book.depth(ob::OrderSide::BUY, summary.bids.data(), resting));
+    summary.asks.resize(resting);
+    summary.asks.resize(
+        order_book.depth(ob::OrderSide::SELL, summary.asks.data(), resting));
+    summary.trades = order_book.sink.trades;
+    summary.volume = order_book.sink.volume;
+    summary.seconds = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+    return summary;
+}
+
+//! Log the levels of one side of a replayed book.
+void show_levels(char const *name,
+                 std::vector<ob::DepthLevel> const &levels) {
+    spdlog::info("===== {} =====", name);
+    for (auto const &level : levels) {
+        spdlog::info("  {}: {} in {} order(s)", level.price, level.quantity,
+                     level.orders);
+    }
+}
+
+/** \brief Replay independent files in parallel, each in its own book.
+ *
+ * The files are handed to a work-stealing pool largest first, so the job
+ * takes about as long as the largest file once there are enough cores. The
+ * summaries are logged in the order the files were given, then their total.
+ */
+int run_replay(Options const &options) {
+    auto const start = std::chrono::steady_clock::now();
+    auto const &paths = options.replay;
+
+    std::vector<std::uintmax_t> sizes(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        std::error_code error;
+        sizes[i] = std::filesystem::file_size(paths[i], error);
+        if (error) {
+            sizes[i] = 0;
+        }
+    }
+    std::vector<std::size_t> largest_first(paths.size());
+    std::iota(std::begin(largest_first), std::end(largest_first), 0);
+    std::stable_sort(
+        std::begin(largest_first), std::end(largest_first),
+        [&sizes](auto left, auto right) { return sizes[left] > sizes[right]; });
+
+    std::vector<ReplaySummary> summaries(paths.size());
+    std::size_t threads = 0;
+    {
+        ob::WorkPool pool(options.threads);
+        threads = pool.thread_count();
+        for (auto index : largest_first) {
+            pool.submit([&options, &paths, &summaries, index] {
+                summaries[index] = replay_file(options, paths[index]);
+            });
+        }
+        pool.wait();
+    }
+
+    ReplaySummary total;
+    total.ok = true;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        auto const &summary = summaries[i];
+        if (!summary.ok) {
+            total.ok = false;
+            continue;
+        }
+        spdlog::info("{}: {} orders, {} trades for {} shares, in {:.3f} s",
+                     paths[i], summary.orders, summary.trades, summary.volume,
+                     summary.seconds);
+        spdlog::info("Final order book for {}:", paths[i]);
+        show_levels("Bids", summary.bids);
+        show_levels("Asks", summary.asks);
+
+        total.orders += summary.orders;
+        total.trades += summary.trades;
+        total.volume += summary.volume;
+        total.seconds += summary.seconds;
+    }
+
+    auto const elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    spdlog::info(
+        "Replayed {} files on {} threads: {} orders, {} trades for {} shares, "
+        "in {:.3f} s ({:.3f} s of work)",
+        paths.size(), threads, total.orders, total.trades, total.volume,
+        elapsed, total.seconds);
+    return total.ok ? 0 : 1;
+}
+
+/** \brief Add the paths listed in a file, one per line.
+ *
+ * \return false if the list cannot be read.
+ */
+bool read_file_list(std::string const &list_path,
+                    std::vector<std::string> &paths) {
+    std::ifstream list(list_path);
+    if (!list) {
+        return false;
+    }
+    for (std::string line; std::getline(list, line);) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            paths.push_back(line);
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int ac, char** av) {
+    ob::init_logging();
+
+    Options options;
+    auto replay = false;
+    auto valid = true;
+    for (int i = 1; i < ac && valid; ++i) {
+        std::string_view arg(av[i]);
+        auto const has_value = i + 1 < ac;
+        if (arg == "--shards" && has_value) {
+            options.shards = std::strtoul(av[++i], nullptr, 10);
+        } else if (arg == "--pipeline") {
+            options.pipeline = true;
+        } else if (arg == "--snapshot" && has_value) {
+            options.snapshot = av[++i];
+        } else if (arg == "--save-snapshot" && has_value) {
+            options.save_snapshot = av[++i];
+        } else if (arg == "--journal" && has_value) {
+            options.journal = av[++i];
+        } else if (arg == "--replay-from" && has_value) {
+            options.replay_from = std::strtoull(av[++i], nullptr, 10);
+        } else if (arg == "--replay-until" && has_value) {
+            options.replay_until = std::strtoull(av[++i], nullptr, 10);
+        } else if (arg == "--auction" && has_value) {
+            options.auction = std::strtoul(av[++i], nullptr, 10);
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--replay") {
+            replay = true;
+        } else if (arg == "--parse-threads" && has_value) {
+            options.parse_threads = std::strtoul(av[++i], nullptr, 10);
+        } else if (arg == "--threads" && has_value) {
+            options.threads = std::strtoul(av[++i], nullptr, 10);
+        } else if (arg == "--file-list" && has_value) {
+            replay = true;
+            if (!read_file_list(av[++i], options.replay)) {
+                spdlog::error("Could not read file list {}", av[i]);
+                return 1;
+            }
+        } else if (replay && arg.substr(0, 2) != "--") {
+            options.replay.emplace_back(arg);
+        } else if (options.file_path.empty() && arg.substr(0, 2) != "--") {
+            options.file_path = arg;
+        } else {
+            valid = false;
+        }
+    }
+
+    // Snapshots and journals hold a single book, and only its operations
+    // are measured or auctioned
+    auto const modes = static_cast<int>(options.pipeline) +
+                       static_cast<int>(options.shards != 0) +
+                       static_cast<int>(replay);
+    auto const single = modes == 0;
+    auto const single_only = !options.snapshot.empty() ||
+                             !options.save_snapshot.empty() ||
+                             !options.journal.empty() || options.stats ||
+                             options.auction > 0;
+    auto const files_given = replay ? !options.replay.empty() &&
+                                          options.file_path.empty()
+                                    : !options.file_path.empty();
+    if (!valid || !files_given || modes > 1 || (single_only && !single) ||
+        (options.threads != 0 && !replay)) {
+        spdlog::error(
+            "Usage: {} [--shards N | --pipeline | [--snapshot FILE] "
+            "[--save-snapshot FILE] [--journal FILE] [--stats] "
+            "[--auction N]] [--replay-from N] [--replay-until N] "
+            "[--parse-threads N] orders_file_path (CSV, binary or journal)",
+            av[0]);
+        spdlog::error(
+            "   or: {} --replay [--threads N] [--file-list FILE] "
+            "[--replay-from N] [--replay-until N] [--parse-threads N] "
+            "orders_file_path...",
+            av[0]);
+        return 1;
+    }
+
+    if (replay) {
+        auto const result = run_replay(options);
+        ob::shutdown_logging();
+        return result;
+    }
+
+    spdlog::debug("Opening file {}", options.file_path);
+    ob::MappedFile file(options.file_path);
+    if (!file) {
+        spdlog::error("Could not open file {}", options.file_path);
+        return 1;
+    }
+
+    auto const result =
+        options.pipeline      ? run_pipeline(file, options)
+        : options.shards != 0 ? run_sharded(file, options)
+        : options.stats       ? run_single<ob::BookStats>(file, options)
+                              : run_single<ob::NullStats>(file, options);
+
+    ob::shutdown_logging();
+    return result;
+}
@@ -0,0 +1,86 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ob {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(std::string const &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return;
+    }
+    this->buffer_.assign(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>());
+    this->data_ = this->buffer_.data();
+    this->size_ = this->buffer_.size();
+    this->ok_ = true;
+}
+
+MappedFile::~MappedFile() = default;
+
+// The whole file is in our buffer, there is nothing to give back
+void MappedFile::discard(std::size_t) {}
+
+#else
+
+MappedFile::MappedFile(std::string const &path) {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0) {
+        this->size_ = static_cast<std::size_t>(status.st_size);
+        if (this->size_ == 0) {
+            // mmap refuses empty mappings, but an empty file is still valid
+            this->ok_ = true;
+        } else {
+            auto data =
+                ::mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                // We read the file once, from start to end
+                ::madvise(data, this->size_, MADV_SEQUENTIAL);
+                this->data_ = static_cast<char const *>(data);
+                this->ok_ = true;
+            }
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (this->data_ != nullptr) {
+        ::munmap(const_cast<char *>(this->data_), this->size_);
+    }
+}
+
+void MappedFile::discard(std::size_t offset) {
+    if (this->data_ == nullptr) {
+        return;
+    }
+    // Only whole pages can be dropped, and the mapping starts on a page
+    auto const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    auto const length = std::min(offset, this->size_) / page * page;
+    if (length > 0) {
+        ::madvise(const_cast<char *>(this->data_), length, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+}  // namespace ob
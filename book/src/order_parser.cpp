@@ -0,0 +1,177 @@
+#include "order_parser.h"
+
+#include <array>
+#include <charconv>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OB_PARSER_SSE2
+#endif
+
+#include "bits.h"
+#include "logging.h"
+
+//! Local helper functions
+namespace {
+
+/** \brief Find the first `c` in [first, last), or return last.
+ *
+ * With SSE2, 16 bytes are compared at once. Blocks may extend past `last`, as
+ * long as they stay before `limit` (the end of the buffer), so that short
+ * ranges like the fields of a line are scanned in one step too.
+ */
+char const *find_byte(char const *first, char const *last, char const *limit,
+                      char c) {
+#if defined(OB_PARSER_SSE2)
+    auto const needle = _mm_set1_epi8(c);
+    while (first < last && limit - first >= 16) {
+        auto const block =
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(first));
+        auto const mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (mask != 0) {
+            auto const found = first + ob::detail::lowest_bit(mask);
+            return found < last ? found : last;
+        }
+        first += 16;
+    }
+#else
+    (void)limit;
+#endif
+    while (first < last && *first != c) {
+        ++first;
+    }
+    return first < last ? first : last;
+}
+
+//! Read a whole field as a number.
+bool parse_int(std::string_view field, int &value) {
+    auto const last = field.data() + field.size();
+    auto const result = std::from_chars(field.data(), last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+/** \brief Read the fields of one line.
+ *
+ * \return the reason why the line is malformed, or null if it is valid.
+ */
+char const *parse_line(char const *first, char const *last,
+                       char const *limit, ob::ParsedLine &line) {
+    std::array<std::string_view, 7> fields;
+    std::size_t count = 0;
+    for (auto field = first;;) {
+        if (count == fields.size()) {
+            return "too many fields";
+        }
+        auto const comma = find_byte(field, last, limit, ',');
+        fields[count++] =
+            std::string_view(field, static_cast<std::size_t>(comma - field));
+        if (comma == last) {
+            break;
+        }
+        field = comma + 1;
+    }
+    if (count < 5) {
+        return "expected 5 to 7 fields";
+    }
+
+    // The time in force is optional, it comes last
+    line.order.time_in_force = ob::TimeInForce::GTC;
+    auto const time_in_force = ob::StringToTimeInForce.find(fields[count - 1]);
+    if (time_in_force != std::end(ob::StringToTimeInForce)) {
+        line.order.time_in_force = time_in_force->second;
+        --count;
+    } else if (count == fields.size()) {
+        return "invalid time in force";
+    }
+
+    auto const order_type = ob::StringToOrderType.find(fields[0]);
+    if (order_type == std::end(ob::StringToOrderType)) {
+        return "invalid order type";
+    }
+    line.type = order_type->second;
+
+    // The symbol is optional, it comes right after the order type
+    auto const *order_fields = &fields[1];
+    line.symbol = std::string_view();
+    if (count == 6) {
+        line.symbol = fields[1];
+        ++order_fields;
+        if (line.symbol.empty()) {
+            return "empty symbol";
+        }
+    }
+
+    if (!parse_int(order_fields[0], line.order.id)) {
+        return "invalid order ID";
+    }
+    if (order_fields[1] == "B") {
+        line.order.side = ob::OrderSide::BUY;
+    } else if (order_fields[1] == "S") {
+        line.order.side = ob::OrderSide::SELL;
+    } else {
+        return "invalid side";
+    }
+    if (!parse_int(order_fields[2], line.order.quantity)) {
+        return "invalid quantity";
+    }
+    if (order_fields[3] == "MKT") {
+        line.order.price = ob::market_price(line.order.side);
+    } else if (!parse_int(order_fields[3], line.order.price)) {
+        return "invalid price";
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+/**
+ * Library implementation
+ */
+namespace ob {
+
+OrderReader::OrderReader(std::string_view text)
+    : begin_(text.data()),
+      position_(text.data()),
+      end_(text.data() + text.size()) {}
+
+bool OrderReader::next(ParsedLine &line) {
+    while (this->position_ < this->end_) {
+        auto const first = this->position_;
+        auto const eol = find_byte(first, this->end_, this->end_, '\n');
+        this->position_ = eol == this->end_ ? eol : eol + 1;
+
+        // Tolerate Windows line endings
+        auto last = eol;
+        if (first != last && *(last - 1) == '\r') {
+            --last;
+        }
+        if (first == last) {
+            continue;
+        }
+
+        OB_LOG_DEBUG("Order text: {}",
+                     std::string_view(
+                         first, static_cast<std::size_t>(last - first)));
+        line.offset = static_cast<std::size_t>(first - this->begin_);
+        line.error = parse_line(first, last, this->end_, line);
+        return true;
+    }
+    return false;
+}
+
+ParsedOrders parse_orders(std::string_view text) {
+    ParsedOrders result;
+    for_each_order(
+        text,
+        [&result](OrderType type, Order const &order) {
+            result.orders.emplace_back(type, order);
+        },
+        [&result](ParseError const &error) {
+            result.errors.push_back(error);
+        });
+    return result;
+}
+
+}  // namespace ob
@@ -0,0 +1,85 @@
+#include "parallel_reader.h"
+
+#include <algorithm>
+
+namespace ob {
+
+ParallelOrderReader::ParallelOrderReader(std::string_view text,
+                                         std::size_t threads,
+                                         std::size_t chunk_size)
+    : text_(text), chunk_size_(std::max<std::size_t>(chunk_size, 1)),
+      pool_(threads) {
+    // One batch per thread being parsed, and the one being read
+    this->batches_ = std::vector<Batch>(this->pool_.thread_count() + 1);
+    for (auto &batch : this->batches_) {
+        this->schedule(batch);
+    }
+}
+
+std::vector<ParsedLine> const *ParallelOrderReader::next() {
+    // The caller is done with the last batch, it can take the next chunk
+    if (this->previous_ != nullptr) {
+        this->schedule(*this->previous_);
+        this->previous_ = nullptr;
+    }
+
+    // Chunks are cut in order, and given to the batches in turn
+    auto &batch = this->batches_[this->current_];
+    if (!batch.cut) {
+        return nullptr;
+    }
+    {
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->parsed_.wait(lock, [&batch] { return batch.ready; });
+    }
+    this->current_ = (this->current_ + 1) % this->batches_.size();
+    this->consumed_ = batch.end;
+    this->previous_ = &batch;
+    return &batch.lines;
+}
+
+void ParallelOrderReader::schedule(Batch &batch) {
+    auto const size = this->text_.size();
+    batch.cut = this->scheduled_ < size;
+    if (!batch.cut) {
+        return;
+    }
+
+    // Cut after the first end of line past the chunk size
+    batch.begin = this->scheduled_;
+    batch.end = size;
+    if (size - batch.begin > this->chunk_size_) {
+        auto const eol =
+            this->text_.find('\n', batch.begin + this->chunk_size_ - 1);
+        if (eol != std::string_view::npos) {
+            batch.end = eol + 1;
+        }
+    }
+    this->scheduled_ = batch.end;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        batch.ready = false;
+    }
+    this->pool_.submit([this, &batch] { this->parse(batch); });
+}
+
+void ParallelOrderReader::parse(Batch &batch) {
+    auto const chunk = this->text_.substr(batch.begin, batch.end - batch.begin);
+    auto const lines = std::count(chunk.begin(), chunk.end(), '\n') + 1;
+    batch.lines.clear();
+    batch.lines.reserve(static_cast<std::size_t>(lines));
+
+    OrderReader reader(chunk);
+    for (ParsedLine line; reader.next(line);) {
+        line.offset += batch.begin;
+        batch.lines.push_back(line);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        batch.ready = true;
+    }
+    this->parsed_.notify_one();
+}
+
+}  // namespace ob
@@ -0,0 +1,126 @@
+#include "prefix_sum.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// GCC and Clang only generate AVX2 code in functions that ask for it, so the
+// rest of the library still runs on any x86-64 CPU
+#if defined(__GNUC__)
+#define OB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define OB_TARGET_AVX2
+#endif
+
+namespace ob::detail {
+
+namespace {
+
+using Kernel = std::size_t (*)(Quantity const *, std::size_t, std::int64_t);
+
+Kernel pick_kernel() {
+    return has_avx2() ? prefix_within_avx2 : prefix_within_scalar;
+}
+
+}  // namespace
+
+std::size_t prefix_within(Quantity const *values, std::size_t count,
+                          std::int64_t budget) {
+    // Picked on the first call, so that books built during static
+    // initialization find it ready
+    static Kernel const kernel = pick_kernel();
+    return kernel(values, count, budget);
+}
+
+std::size_t prefix_within_scalar(Quantity const *values, std::size_t count,
+                                 std::int64_t budget) {
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        sum += values[i];
+        if (sum > budget) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+namespace {
+
+//! Four values, as 64-bit integers.
+OB_TARGET_AVX2 __m256i widen(Quantity const *values) {
+    return _mm256_cvtepi32_epi64(
+        _mm_loadu_si128(reinterpret_cast<__m128i const *>(values)));
+}
+
+}  // namespace
+
+OB_TARGET_AVX2 std::size_t prefix_within_avx2(Quantity const *values,
+                                              std::size_t count,
+                                              std::int64_t budget) {
+    // The sums only grow: add up blocks of 16 values, widened to 64 bits,
+    // until one goes over the budget, then find the value that does
+    std::int64_t sum = 0;
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        auto const lanes =
+            _mm256_add_epi64(_mm256_add_epi64(widen(values + i),
+                                              widen(values + i + 4)),
+                             _mm256_add_epi64(widen(values + i + 8),
+                                              widen(values + i + 12)));
+        auto pair = _mm_add_epi64(_mm256_castsi256_si128(lanes),
+                                  _mm256_extracti128_si256(lanes, 1));
+        pair = _mm_add_epi64(pair, _mm_unpackhi_epi64(pair, pair));
+        auto const block = static_cast<std::int64_t>(_mm_cvtsi128_si64(pair));
+        if (sum + block > budget) {
+            break;
+        }
+        sum += block;
+    }
+
+    for (; i < count; ++i) {
+        sum += values[i];
+        if (sum > budget) {
+            return i;
+        }
+    }
+    return count;
+}
+
+bool has_avx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // The OS must also save the YMM registers on context switches
+    __cpuid(info, 1);
+    auto const osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#else
+
+std::size_t prefix_within_avx2(Quantity const *values, std::size_t count,
+                               std::int64_t budget) {
+    return prefix_within_scalar(values, count, budget);
+}
+
+bool has_avx2() { return false; }
+
+#endif
+
+}  // namespace ob::detail
@@ -0,0 +1,172 @@
+#include "snapshot.h"
+
+#include <algorithm>
+
+#include "little_endian.h"
+
+//! Local helper functions
+namespace {
+
+using ob::detail::load;
+using ob::detail::store;
+
+constexpr std::uint64_t fnv_offset = 14695981039346656037ull;
+constexpr std::uint64_t fnv_prime = 1099511628211ull;
+
+//! Continue a 64-bit FNV-1a hash with more bytes.
+std::uint64_t fnv1a(std::uint64_t hash, char const *data, std::size_t size) {
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+/** \brief Walk the sides and levels without decoding the orders.
+ *
+ * \return the reason why the layout is invalid, or null.
+ */
+char const *check_layout(char const *position, char const *end,
+                         std::uint64_t orders) {
+    std::uint64_t found = 0;
+    for (int side = 0; side < 2; ++side) {
+        if (end - position < 4) {
+            return "truncated side";
+        }
+        auto levels = load<std::uint32_t>(position);
+        position += 4;
+        for (; levels > 0; --levels) {
+            if (static_cast<std::size_t>(end - position) <
+                ob::snapshot::level_size) {
+                return "truncated level";
+            }
+            auto const count = load<std::uint32_t>(position + 4);
+            position += ob::snapshot::level_size;
+            if (count == 0) {
+                return "empty level";
+            }
+            if (static_cast<std::size_t>(end - position) / count <
+                ob::snapshot::order_size) {
+                return "truncated level";
+            }
+            position += count * ob::snapshot::order_size;
+            found += count;
+        }
+    }
+    if (position != end) {
+        return "unexpected data after the levels";
+    }
+    if (found != orders) {
+        return "wrong number of orders";
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+namespace ob::snapshot {
+
+bool has_magic(std::string_view data) {
+    return data.size() >= sizeof(magic) &&
+           std::equal(std::begin(magic), std::end(magic), data.data());
+}
+
+Writer::Writer(std::ostream &stream, std::uint64_t sequence,
+               std::uint64_t orders, std::uint64_t journal)
+    : stream_(stream), hash_(fnv_offset) {
+    char header[header_size] = {};
+    std::copy(std::begin(magic), std::end(magic), header);
+    store<std::uint16_t>(header + 8, version);
+    store<std::uint64_t>(header + 16, sequence);
+    store<std::uint64_t>(header + 24, orders);
+    store<std::uint64_t>(header + 32, journal);
+    this->write(header, header_size);
+}
+
+void Writer::side(std::uint32_t levels) {
+    char data[4];
+    store<std::uint32_t>(data, levels);
+    this->write(data, sizeof(data));
+}
+
+void Writer::level(Price price, std::uint32_t orders) {
+    char data[level_size];
+    store<std::int32_t>(data, price);
+    store<std::uint32_t>(data + 4, orders);
+    this->write(data, sizeof(data));
+}
+
+void Writer::order(OrderId id, Quantity quantity) {
+    char data[order_size];
+    store<std::int32_t>(data, id);
+    store<std::int32_t>(data + 4, quantity);
+    this->write(data, sizeof(data));
+}
+
+void Writer::finish() {
+    char data[checksum_size];
+    store<std::uint64_t>(data, this->hash_);
+    this->stream_.write(data, sizeof(data));
+}
+
+void Writer::write(char const *data, std::size_t size) {
+    this->hash_ = fnv1a(this->hash_, data, size);
+    this->stream_.write(data, static_cast<std::streamsize>(size));
+}
+
+Reader::Reader(std::string_view data) {
+    if (data.size() < header_size + checksum_size || !has_magic(data)) {
+        this->error_ = "not a snapshot";
+        return;
+    }
+    if (load<std::uint16_t>(data.data() + 8) != version) {
+        this->error_ = "unsupported version";
+        return;
+    }
+
+    auto const end = data.data() + data.size() - checksum_size;
+    auto const body = static_cast<std::size_t>(end - data.data());
+    if (fnv1a(fnv_offset, data.data(), body) != load<std::uint64_t>(end)) {
+        this->error_ = "checksum mismatch";
+        return;
+    }
+
+    this->sequence_ = load<std::uint64_t>(data.data() + 16);
+    this->orders_ = load<std::uint64_t>(data.data() + 24);
+    this->journal_ = load<std::uint64_t>(data.data() + 32);
+    this->error_ =
+        check_layout(data.data() + header_size, end, this->orders_);
+    if (this->error_ == nullptr) {
+        this->position_ = data.data() + header_size;
+    }
+}
+
+bool Reader::next(Level &level) {
+    if (this->error_ != nullptr) {
+        return false;
+    }
+    while (this->levels_left_ == 0) {
+        if (this->sides_read_ == 2) {
+            return false;
+        }
+        ++this->sides_read_;
+        this->levels_left_ = load<std::uint32_t>(this->position_);
+        this->position_ += 4;
+    }
+
+    level.side = this->sides_read_ == 1 ? OrderSide::BUY : OrderSide::SELL;
+    level.price = load<std::int32_t>(this->position_);
+    level.orders = load<std::uint32_t>(this->position_ + 4);
+    level.data = this->position_ + level_size;
+    this->position_ = level.data + level.orders * order_size;
+    --this->levels_left_;
+    return true;
+}
+
+Order Reader::order(Level const &level, std::size_t index) {
+    auto const data = level.data + index * order_size;
+    return Order{load<std::int32_t>(data), level.side,
+                 load<std::int32_t>(data + 4), level.price, TimeInForce::GTC};
+}
+
+}  // namespace ob::snapshot
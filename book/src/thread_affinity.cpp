@@ -0,0 +1,32 @@
+#include "thread_affinity.h"
+
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ob {
+
+#if defined(__linux__)
+
+bool pin_current_thread(std::size_t core) {
+    auto const cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cores, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#else
+
+bool pin_current_thread(std::size_t) { return false; }
+
+#endif
+
+}  // namespace ob
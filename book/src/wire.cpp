@@ -0,0 +1,56 @@
+#include "wire.h"
+
+#include "little_endian.h"
+
+namespace ob::wire {
+
+using detail::load;
+using detail::store;
+
+void encode(char *data, Report const &report) {
+    data[0] = static_cast<char>(report.kind);
+    data[1] = report.side == OrderSide::BUY ? 'B' : 'S';
+    data[2] = 0;
+    data[3] = 0;
+    store<std::int32_t>(data + 4, report.id);
+    store<std::int32_t>(data + 8, report.quantity);
+    store<std::int32_t>(data + 12, report.price);
+    store<std::int32_t>(data + 16, report.other_id);
+    store<std::int32_t>(data + 20, report.remaining);
+}
+
+bool decode(char const *data, Report &report) {
+    // Any byte converts to the enum, only the listed ones are kinds
+    auto const kind = static_cast<ReportKind>(data[0]);
+    switch (kind) {
+        case ReportKind::ACCEPTED:
+        case ReportKind::CANCELLED:
+        case ReportKind::AMENDED:
+        case ReportKind::REJECTED:
+        case ReportKind::FILL:
+            report.kind = kind;
+            break;
+        default:
+            return false;
+    }
+
+    switch (data[1]) {
+        case 'B':
+            report.side = OrderSide::BUY;
+            break;
+        case 'S':
+            report.side = OrderSide::SELL;
+            break;
+        default:
+            return false;
+    }
+
+    report.id = load<std::int32_t>(data + 4);
+    report.quantity = load<std::int32_t>(data + 8);
+    report.price = load<std::int32_t>(data + 12);
+    report.other_id = load<std::int32_t>(data + 16);
+    report.remaining = load<std::int32_t>(data + 20);
+    return true;
+}
+
+}  // namespace ob::wire
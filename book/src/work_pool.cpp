@@ -0,0 +1,110 @@
+#include "work_pool.h"
+
+#include <utility>
+
+namespace ob {
+
+WorkPool::WorkPool(std::size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        this->workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        this->workers_[i]->thread = std::thread([this, i] { this->run(i); });
+    }
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stopping_ = true;
+    }
+    this->ready_.notify_all();
+    for (auto &worker : this->workers_) {
+        worker->thread.join();
+    }
+}
+
+void WorkPool::submit(Task task) {
+    auto const index = this->next_.fetch_add(1, std::memory_order_relaxed) %
+                       this->workers_.size();
+    auto &worker = *this->workers_[index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    // Counted once queued, so a thread that takes the count finds the task
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        ++this->queued_;
+        ++this->unfinished_;
+    }
+    this->ready_.notify_one();
+}
+
+void WorkPool::wait() {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->idle_.wait(lock, [this] { return this->unfinished_ == 0; });
+}
+
+WorkPool::Task WorkPool::take(std::size_t self) {
+    auto const count = this->workers_.size();
+    for (;;) {
+        // Our own queue first, oldest task first
+        {
+            auto &worker = *this->workers_[self];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (!worker.tasks.empty()) {
+                auto task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+                return task;
+            }
+        }
+        // Then steal from the others, newest task first
+        for (std::size_t i = 1; i < count; ++i) {
+            auto &victim = *this->workers_[(self + i) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                auto task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+                return task;
+            }
+        }
+        // Another thread took our task, and the one left for us went to a
+        // queue we had already looked at: look again
+        std::this_thread::yield();
+    }
+}
+
+void WorkPool::run(std::size_t self) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->ready_.wait(lock, [this] {
+                return this->queued_ > 0 || this->stopping_;
+            });
+            if (this->queued_ == 0) {
+                return;
+            }
+            --this->queued_;
+        }
+
+        this->take(self)();
+
+        bool idle = false;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            idle = --this->unfinished_ == 0;
+        }
+        if (idle) {
+            this->idle_.notify_all();
+        }
+    }
+}
+
+}  // namespace ob
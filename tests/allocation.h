@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace obt {
+
+//! Memory resource counting the allocations it forwards to the heap.
+class CountingResource final : public std::pmr::memory_resource {
+   public:
+    std::size_t allocations = 0;
+
+   private:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++this->allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *pointer, std::size_t bytes,
+                       std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+    }
+
+    bool do_is_equal(
+        std::pmr::memory_resource const &other) const noexcept override {
+        return this == &other;
+    }
+};
+
+/** \brief Fill 40 bid levels, cancel some orders, then sweep them all.
+ *
+ * The book is left empty, so every round goes through the same levels.
+ */
+template <typename Book>
+void churn(Book &book, ob::OrderId &next_id) {
+    auto const first = next_id;
+    for (ob::Price price = 200; price < 400; price += 5) {
+        for (int i = 0; i < 6; ++i) {
+            ob::Order bid{next_id++, ob::OrderSide::BUY, 10, price};
+            book.bid(bid);
+        }
+    }
+    for (auto id = first; id < next_id; id += 4) {
+        ASSERT_TRUE(book.cancel(id));
+    }
+    ob::Order sweep{next_id++, ob::OrderSide::SELL, 1 << 20, 200,
+                    ob::TimeInForce::IOC};
+    book.ask(sweep);
+    ASSERT_TRUE(book.bids.empty());
+    ASSERT_TRUE(book.asks.empty());
+}
+
+template <typename Backend>
+void expect_warm_book_does_not_allocate() {
+    spdlog::set_level(spdlog::level::critical);
+    CountingResource upstream;
+    ob::OrderBook<Backend> book{ob::LadderConfig{100, 5, 256}, ob::NullSink(),
+                                &upstream};
+    ob::OrderId next_id = 1;
+    for (int round = 0; round < 3; ++round) {
+        churn(book, next_id);
+    }
+    ASSERT_GT(upstream.allocations, 0u) << "The book uses the resource";
+
+    auto const warm = upstream.allocations;
+    for (int round = 0; round < 20; ++round) {
+        churn(book, next_id);
+    }
+    ASSERT_EQ(upstream.allocations, warm);
+}
+
+TEST(AllocationTest, TestWarmMapBookDoesNotAllocate) {
+    expect_warm_book_does_not_allocate<ob::MapBackend>();
+}
+
+TEST(AllocationTest, TestWarmFlatBookDoesNotAllocate) {
+    expect_warm_book_does_not_allocate<ob::FlatBackend>();
+}
+
+}  // namespace obt
@@ -0,0 +1,102 @@
+#pragma once
+
+namespace obt {
+
+template <typename Book>
+void check_amend(Book &order_book) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 110};
+    ob::Order ask2{2, ob::OrderSide::SELL, 10, 110};
+    order_book.ask(ask1);
+    order_book.ask(ask2);
+
+    // Less quantity at the same price: same place in the queue
+    ob::Order reduced{1, ob::OrderSide::SELL, 2, 110};
+    ASSERT_TRUE(order_book.amend(reduced));
+    ASSERT_EQ(table(order_book.asks), (Table{{110, {reduced, ask2}}}));
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::SELL, 110), 12);
+
+    // More quantity: back of the queue
+    ob::Order increased{1, ob::OrderSide::SELL, 8, 110};
+    ASSERT_TRUE(order_book.amend(increased));
+    ASSERT_EQ(table(order_book.asks), (Table{{110, {ask2, increased}}}));
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::SELL, 110), 18);
+
+    // New price: back of the queue of the new level, the old one is gone
+    ob::Order moved{2, ob::OrderSide::SELL, 10, 115};
+    ASSERT_TRUE(order_book.amend(moved));
+    ASSERT_EQ(table(order_book.asks),
+              (Table{{110, {increased}}, {115, {moved}}}));
+
+    // A bid moved across the spread is matched like a new order
+    ob::Order bid{3, ob::OrderSide::BUY, 10, 100};
+    order_book.bid(bid);
+    ob::Order crossing{3, ob::OrderSide::BUY, 10, 110};
+    ASSERT_TRUE(order_book.amend(crossing));
+    ASSERT_EQ(crossing.quantity, 2) << "Left after matching";
+    ASSERT_EQ(table(order_book.asks), (Table{{115, {moved}}}));
+    ASSERT_EQ(table(order_book.bids), (Table{{110, {crossing}}}));
+
+    // Rejected amends leave the book as it was
+    ob::Order unknown{4, ob::OrderSide::BUY, 1, 110};
+    ob::Order other_side{3, ob::OrderSide::SELL, 2, 110};
+    ob::Order no_quantity{3, ob::OrderSide::BUY, 0, 110};
+    ASSERT_FALSE(order_book.amend(unknown));
+    ASSERT_FALSE(order_book.amend(other_side));
+    ASSERT_FALSE(order_book.amend(no_quantity));
+    ASSERT_EQ(table(order_book.asks), (Table{{115, {moved}}}));
+    ASSERT_EQ(table(order_book.bids), (Table{{110, {crossing}}}));
+}
+
+TEST_F(OrderBookTest, TestAmend) { check_amend(this->order_book); }
+
+TEST_F(FlatOrderBookTest, TestAmend) {
+    check_amend(this->order_book);
+
+    ob::Order outside{3, ob::OrderSide::BUY, 2, 1};
+    ASSERT_FALSE(order_book.amend(outside));
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::BUY, 110), 2);
+}
+
+TEST_F(EventsTest, TestAmendEvents) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 110};
+    ob::Order ask2{2, ob::OrderSide::SELL, 10, 110};
+    order_book.ask(ask1);
+    order_book.ask(ask2);
+    order_book.sink.level_updates.clear();
+
+    ob::Order reduced{1, ob::OrderSide::SELL, 3, 110};
+    order_book.amend(reduced);
+    ASSERT_EQ(order_book.sink.reduced.size(), 1u);
+    ASSERT_EQ(order_book.sink.reduced[0].order, reduced);
+    ASSERT_EQ(order_book.sink.reduced[0].reduced_by, 2);
+    ASSERT_EQ(order_book.sink.level_updates.size(), 1u);
+    ASSERT_EQ(order_book.sink.level_updates[0][0].quantity, 13);
+
+    // The level is emptied then refilled: one update, one batch
+    ob::Order increased{1, ob::OrderSide::SELL, 6, 110};
+    order_book.amend(increased);
+    ASSERT_EQ(order_book.sink.cancelled.size(), 1u);
+    ASSERT_EQ(order_book.sink.added.back().order, increased);
+    ASSERT_EQ(order_book.sink.level_updates.size(), 2u);
+    ASSERT_EQ(order_book.sink.level_updates[1].size(), 1u);
+    ASSERT_EQ(order_book.sink.level_updates[1][0].quantity, 16);
+
+    // Two levels change in the same batch
+    ob::Order moved{2, ob::OrderSide::SELL, 10, 120};
+    order_book.amend(moved);
+    ASSERT_EQ(order_book.sink.level_updates.size(), 3u);
+    ASSERT_EQ(order_book.sink.level_updates[2].size(), 2u);
+}
+
+TEST(AmendTest, TestOrderType) {
+    ASSERT_EQ(ob::StringToOrderType.at("M"), ob::OrderType::MODIFY);
+    ASSERT_EQ(ob::OrderTypeToChar(ob::OrderType::MODIFY), 'M');
+
+    ob::ParsedLine line;
+    ob::OrderReader reader("M,1,B,5,100\n");
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_EQ(line.type, ob::OrderType::MODIFY);
+}
+
+}  // namespace obt
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+namespace obt {
+
+TEST(BinaryFormatTest, TestRoundTrip) {
+    std::ostringstream stream;
+    ob::binary::Writer writer(stream, false);
+    writer.write(ob::OrderType::NEW, {1, ob::OrderSide::SELL, 10, 1075});
+    writer.write(ob::OrderType::CANCEL, {1, ob::OrderSide::SELL, 10, 1075});
+    writer.write(ob::OrderType::NEW, {-2, ob::OrderSide::BUY, 3, -5});
+
+    auto data = stream.str();
+    ASSERT_EQ(data.size(),
+              ob::binary::header_size + 3 * ob::binary::record_size);
+    ASSERT_TRUE(ob::binary::has_magic(data));
+
+    ob::binary::Reader reader(data);
+    ASSERT_EQ(reader.error(), nullptr);
+    ASSERT_FALSE(reader.has_timestamps());
+    ASSERT_EQ(reader.size(), 3);
+
+    ob::binary::Record record;
+    ASSERT_TRUE(reader.read(1, record));
+    ASSERT_EQ(record.type, ob::OrderType::CANCEL);
+    ASSERT_EQ(record.order, (ob::Order{1, ob::OrderSide::SELL, 10, 1075}));
+    ASSERT_TRUE(reader.read(2, record));
+    ASSERT_EQ(record.order, (ob::Order{-2, ob::OrderSide::BUY, 3, -5}));
+    ASSERT_EQ(record.timestamp, 0);
+}
+
+TEST(BinaryFormatTest, TestTimestamps) {
+    std::ostringstream stream;
+    ob::binary::Writer writer(stream, true);
+    writer.write(ob::OrderType::NEW, {1, ob::OrderSide::BUY, 10, 5},
+                 1589728505526000000);
+
+    auto data = stream.str();
+    ob::binary::Reader reader(data);
+    ASSERT_TRUE(reader.has_timestamps());
+    ASSERT_EQ(reader.size(), 1);
+
+    ob::binary::Record record;
+    ASSERT_TRUE(reader.read(0, record));
+    ASSERT_EQ(record.timestamp, 1589728505526000000);
+}
+
+TEST(BinaryFormatTest, TestInvalidFiles) {
+    ASSERT_NE(ob::binary::Reader("A,1,S,1,1075\n").error(), nullptr);
+
+    std::ostringstream stream;
+    ob::binary::Writer writer(stream, false);
+    writer.write(ob::OrderType::NEW, {1, ob::OrderSide::BUY, 10, 5});
+    auto data = stream.str();
+
+    auto truncated = data.substr(0, data.size() - 1);
+    ASSERT_NE(ob::binary::Reader(truncated).error(), nullptr);
+
+    auto wrong_version = data;
+    wrong_version[8] = 2;
+    ASSERT_NE(ob::binary::Reader(wrong_version).error(), nullptr);
+
+    auto wrong_side = data;
+    wrong_side[ob::binary::header_size + 1] = 'Q';
+    ob::binary::Reader reader(wrong_side);
+    ASSERT_EQ(reader.error(), nullptr);
+    ob::binary::Record record;
+    ASSERT_FALSE(reader.read(0, record));
+}
+
+}  // namespace obt
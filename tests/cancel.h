@@ -8,13 +8,13 @@ TEST_F(OrderBookTest, TestCancelAsk) {
     ob::Order ask2{2, ob::OrderSide::SELL, 10, 110};
     order_book.ask(ask2);
 
-    auto expected_asks = ob::Asks{{110, {ask1, ask2}}};
-    ASSERT_EQ(order_book.asks, expected_asks);
+    auto expected_asks = Table{{110, {ask1, ask2}}};
+    ASSERT_EQ(table(order_book.asks), expected_asks);
 
     order_book.cancel(ask1);
 
-    auto expected_remaining_asks = ob::Asks{{110, {ask2}}};
-    ASSERT_EQ(order_book.asks, expected_remaining_asks);
+    auto expected_remaining_asks = Table{{110, {ask2}}};
+    ASSERT_EQ(table(order_book.asks), expected_remaining_asks);
 }
 
 TEST_F(OrderBookTest, TestCancelBid) {
@@ -23,13 +23,13 @@ TEST_F(OrderBookTest, TestCancelBid) {
     ob::Order bid2{2, ob::OrderSide::BUY, 10, 110};
     order_book.bid(bid2);
 
-    auto expected_bids = ob::Bids{{110, {bid1, bid2}}};
-    ASSERT_EQ(order_book.bids, expected_bids);
+    auto expected_bids = Table{{110, {bid1, bid2}}};
+    ASSERT_EQ(table(order_book.bids), expected_bids);
 
     order_book.cancel(bid1);
 
-    auto expected_remaining_bids = ob::Bids{{110, {bid2}}};
-    ASSERT_EQ(order_book.bids, expected_remaining_bids);
+    auto expected_remaining_bids = Table{{110, {bid2}}};
+    ASSERT_EQ(table(order_book.bids), expected_remaining_bids);
 }
 
 TEST_F(OrderBookTest, TestCancelAskEmpty) {
@@ -45,4 +45,34 @@ TEST_F(OrderBookTest, TestCancelBidEmpty) {
     order_book.cancel(bid);
     ASSERT_TRUE(order_book.bids.empty());
 }
+
+TEST_F(OrderBookTest, TestCancelById) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(ask1);
+    ob::Order ask2{2, ob::OrderSide::SELL, 10, 110};
+    order_book.ask(ask2);
+    ob::Order bid1{3, ob::OrderSide::BUY, 7, 100};
+    order_book.bid(bid1);
+
+    // Neither the side nor the price are needed to find the order
+    ASSERT_TRUE(order_book.cancel(2));
+    ASSERT_TRUE(order_book.cancel(3));
+    ASSERT_FALSE(order_book.cancel(3)) << "The order was already cancelled";
+
+    auto expected_asks = Table{{110, {ask1}}};
+    ASSERT_EQ(table(order_book.asks), expected_asks);
+    ASSERT_TRUE(order_book.bids.empty());
+    ASSERT_EQ(order_book.order_index.size(), 1);
+}
+
+TEST_F(OrderBookTest, TestCancelFilledOrder) {
+    ob::Order ask{1, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(ask);
+    ob::Order bid{2, ob::OrderSide::BUY, 5, 110};
+    order_book.bid(bid);
+
+    ASSERT_TRUE(order_book.order_index.empty())
+        << "Filled orders should leave the index";
+    ASSERT_FALSE(order_book.cancel(ask));
+}
 }  // namespace obt
\ No newline at end of file
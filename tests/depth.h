@@ -0,0 +1,85 @@
+#pragma once
+
+namespace obt {
+
+using Depth = std::vector<ob::DepthLevel>;
+
+//! The `n` best levels of a side, as a vector.
+template <typename Book>
+Depth depth(Book const &book, ob::OrderSide side, std::size_t n) {
+    Depth result(n);
+    result.resize(book.depth(side, result.data(), n));
+    return result;
+}
+
+template <typename Book>
+void check_depth(Book &order_book) {
+    ob::Order bid1{1, ob::OrderSide::BUY, 10, 1000};
+    ob::Order bid2{2, ob::OrderSide::BUY, 5, 1000};
+    ob::Order bid3{3, ob::OrderSide::BUY, 7, 995};
+    ob::Order ask1{4, ob::OrderSide::SELL, 3, 1010};
+    order_book.bid(bid1);
+    order_book.bid(bid2);
+    order_book.bid(bid3);
+    order_book.ask(ask1);
+
+    ASSERT_EQ(depth(order_book, ob::OrderSide::BUY, 10),
+              (Depth{{1000, 15, 2}, {995, 7, 1}}));
+    ASSERT_EQ(depth(order_book, ob::OrderSide::SELL, 10),
+              (Depth{{1010, 3, 1}}));
+    ASSERT_EQ(depth(order_book, ob::OrderSide::BUY, 1),
+              (Depth{{1000, 15, 2}}))
+        << "Only the best levels are copied";
+
+    // Partial fill of the first bid
+    ob::Order ask2{5, ob::OrderSide::SELL, 4, 1000};
+    order_book.ask(ask2);
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::BUY, 1000), 11);
+
+    // The first bid is filled, the second one partially
+    ob::Order ask3{6, ob::OrderSide::SELL, 8, 1000};
+    order_book.ask(ask3);
+    ASSERT_EQ(depth(order_book, ob::OrderSide::BUY, 10),
+              (Depth{{1000, 3, 1}, {995, 7, 1}}));
+
+    order_book.cancel(2);
+    ASSERT_EQ(depth(order_book, ob::OrderSide::BUY, 10),
+              (Depth{{995, 7, 1}}));
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::BUY, 1000), 0);
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::SELL, 1010), 3);
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::SELL, 1234), 0);
+}
+
+TEST_F(OrderBookTest, TestDepth) { check_depth(this->order_book); }
+
+TEST_F(FlatOrderBookTest, TestDepth) { check_depth(this->order_book); }
+
+/**
+ * After any mix of orders, each level must hold the sum of its orders.
+ */
+TEST_F(OrderBookTest, TestDepthMatchesOrders) {
+    spdlog::set_level(spdlog::level::critical);
+    for (ob::OrderId id = 1; id <= 3000; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 13 + 1, 1000 + (id * 37) % 40};
+        if (id % 4 == 0) {
+            this->order_book.cancel(id - 5);
+        } else {
+            this->order_book.place_order(order);
+        }
+    }
+
+    auto const check = [](auto const &side) {
+        side.for_each_limit([](ob::Price, ob::Limit const &limit) {
+            ob::Quantity total = 0;
+            for (auto const &order : limit) {
+                total += order.quantity;
+            }
+            ASSERT_EQ(limit.quantity(), total);
+        });
+    };
+    check(this->order_book.bids);
+    check(this->order_book.asks);
+}
+
+}  // namespace obt
@@ -0,0 +1,145 @@
+#pragma once
+
+namespace obt {
+
+TEST_F(EventsTest, TestOrderAdded) {
+    ob::Order bid{1, ob::OrderSide::BUY, 10, 100};
+    order_book.bid(bid);
+
+    auto const &added = order_book.sink.added;
+    ASSERT_EQ(added.size(), 1);
+    ASSERT_EQ(added[0].order, bid);
+    ASSERT_TRUE(order_book.sink.trades.empty());
+}
+
+TEST_F(EventsTest, TestTradesAndLeftover) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 3, 105};
+    order_book.ask(ask1);
+    ob::Order ask2{2, ob::OrderSide::SELL, 7, 105};
+    order_book.ask(ask2);
+    ob::Order ask3{3, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(ask3);
+
+    ob::Order bid{4, ob::OrderSide::BUY, 4, 105};
+    order_book.bid(bid);
+
+    auto const &trades = order_book.sink.trades;
+    ASSERT_EQ(trades.size(), 2);
+    ASSERT_EQ(trades[0].incoming_id, 4);
+    ASSERT_EQ(trades[0].resting_id, 1);
+    ASSERT_EQ(trades[0].quantity, 3);
+    ASSERT_EQ(trades[0].resting_remaining, 0);
+    ASSERT_EQ(trades[1].resting_id, 2);
+    ASSERT_EQ(trades[1].price, 105);
+    ASSERT_EQ(trades[1].quantity, 1);
+    ASSERT_EQ(trades[1].resting_remaining, 6);
+
+    // Only the partially filled order is reduced, the other one left the book
+    auto const &reduced = order_book.sink.reduced;
+    ASSERT_EQ(reduced.size(), 1);
+    ASSERT_EQ(reduced[0].order.id, 2);
+    ASSERT_EQ(reduced[0].order.quantity, 6);
+    ASSERT_EQ(reduced[0].reduced_by, 1);
+
+    // The three asks rested, the bid was fully executed
+    ASSERT_EQ(order_book.sink.added.size(), 3);
+}
+
+TEST_F(EventsTest, TestOrderCancelled) {
+    ob::Order ask{1, ob::OrderSide::SELL, 3, 105};
+    order_book.ask(ask);
+    order_book.cancel(1);
+    order_book.cancel(1);
+
+    auto const &cancelled = order_book.sink.cancelled;
+    ASSERT_EQ(cancelled.size(), 1);
+    ASSERT_EQ(cancelled[0].order, ask);
+}
+
+/**
+ * An order sweeping two levels and resting the rest sends one batch, with
+ * one update per level and consecutive sequence numbers.
+ */
+TEST_F(EventsTest, TestLevelUpdates) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 3, 100};
+    order_book.ask(ask1);
+    ob::Order ask2{2, ob::OrderSide::SELL, 2, 100};
+    order_book.ask(ask2);
+    ob::Order ask3{3, ob::OrderSide::SELL, 5, 105};
+    order_book.ask(ask3);
+    ASSERT_EQ(order_book.sink.level_updates.size(), 3);
+
+    ob::Order bid{4, ob::OrderSide::BUY, 12, 105};
+    order_book.bid(bid);
+
+    auto const &batch = order_book.sink.level_updates.back();
+    ASSERT_EQ(batch.size(), 3);
+    ASSERT_EQ(batch[0].side, ob::OrderSide::SELL);
+    ASSERT_EQ(batch[0].price, 100);
+    ASSERT_EQ(batch[0].quantity, 0);
+    ASSERT_EQ(batch[1].price, 105);
+    ASSERT_EQ(batch[1].quantity, 0);
+    ASSERT_EQ(batch[2].side, ob::OrderSide::BUY);
+    ASSERT_EQ(batch[2].price, 105);
+    ASSERT_EQ(batch[2].quantity, 2);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        ASSERT_EQ(batch[i].sequence, 4 + i);
+    }
+    ASSERT_EQ(order_book.sequence(), 6);
+
+    // Cancels update their level, unknown IDs send nothing
+    order_book.cancel(4);
+    order_book.cancel(4);
+    ASSERT_EQ(order_book.sink.level_updates.size(), 5);
+    ASSERT_EQ(order_book.sink.level_updates.back()[0].quantity, 0);
+}
+
+/**
+ * A mirror started from a snapshot in the middle of the day, fed with the
+ * batches sent before and after it, ends up with the levels of the book.
+ */
+TEST_F(EventsTest, TestDepthMirror) {
+    spdlog::set_level(spdlog::level::critical);
+    ob::DepthMirror mirror;
+    std::size_t applied = 0;
+
+    for (ob::OrderId id = 1; id <= 2000; ++id) {
+        if (id == 1000) {
+            mirror.reset(order_book);
+            // Batches sent up to now must not be applied twice
+            applied = order_book.sink.level_updates.size() - 5;
+        }
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 9 + 1, 1000 + (id * 37) % 50};
+        if (id % 5 == 0) {
+            order_book.cancel(id - 3);
+        } else {
+            order_book.place_order(order);
+        }
+    }
+
+    auto const &batches = order_book.sink.level_updates;
+    for (; applied < batches.size(); ++applied) {
+        auto const &batch = batches[applied];
+        ASSERT_TRUE(mirror.apply(
+            ob::LevelUpdates{batch.data(), batch.data() + batch.size()}));
+    }
+    ASSERT_EQ(mirror.sequence(), order_book.sequence());
+
+    ob::DepthMirror::Bids bids;
+    order_book.bids.for_each_limit([&bids](ob::Price p, ob::Limit const &l) {
+        bids.emplace(p, l.quantity());
+    });
+    ob::DepthMirror::Asks asks;
+    order_book.asks.for_each_limit([&asks](ob::Price p, ob::Limit const &l) {
+        asks.emplace(p, l.quantity());
+    });
+    ASSERT_EQ(mirror.bids(), bids);
+    ASSERT_EQ(mirror.asks(), asks);
+
+    // A missing batch is detected
+    ob::LevelUpdate late{mirror.sequence() + 2, ob::OrderSide::BUY, 1, 1};
+    ASSERT_FALSE(mirror.apply(ob::LevelUpdates{&late, &late + 1}));
+}
+
+}  // namespace obt
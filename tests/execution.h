@@ -7,8 +7,8 @@ TEST_F(OrderBookTest, TestBidExecutionSimpleMatch) {
     ob::Order order_sell{2, ob::OrderSide::SELL, 10, 5};
 
     order_book.ask(order_sell);
-    auto expected_asks = ob::Asks{{5, {order_sell}}};
-    ASSERT_EQ(order_book.asks, expected_asks);
+    auto expected_asks = Table{{5, {order_sell}}};
+    ASSERT_EQ(table(order_book.asks), expected_asks);
 
     order_book.bid(order_buy);
     ASSERT_TRUE(order_book.bids.empty())
@@ -41,11 +41,11 @@ TEST_F(OrderBookTest, TestBidExecutionMultipleMatches) {
     ob::Order ask4{4, ob::OrderSide::SELL, 7, 105};
     order_book.ask(ask4);
 
-    auto expected_asks = ob::Asks{
+    auto expected_asks = Table{
         {110, {ask1, ask2}},  // we should have these 2 orders at the same limit
         {105, {ask3, ask4}}   // and these 2 here
     };
-    ASSERT_EQ(order_book.asks, expected_asks);
+    ASSERT_EQ(table(order_book.asks), expected_asks);
 
     /**
      * Now, let’s imagine some buyer places an “aggressive” order to buy 4
@@ -76,11 +76,11 @@ TEST_F(OrderBookTest, TestBidExecutionMultipleMatches) {
      * =================
      */
 
-    auto expected_remaining_asks = ob::Asks{
+    auto expected_remaining_asks = Table{
         {110, {ask1, ask2}},  // This limit is left unchanged
         {105, {{4, ob::OrderSide::SELL, 6, 105}}}  // Leftover order #4
     };
-    ASSERT_EQ(order_book.asks, expected_remaining_asks);
+    ASSERT_EQ(table(order_book.asks), expected_remaining_asks);
 }
 
 /**
@@ -93,8 +93,8 @@ TEST_F(OrderBookTest, TestAskExecutionMultipleMatches) {
     order_book.ask(ask2);
     ob::Order ask3{3, ob::OrderSide::SELL, 6, 105};
     order_book.ask(ask3);
-    ASSERT_EQ(order_book.asks[110].size(), 2);
-    ASSERT_EQ(order_book.asks[105].size(), 1);
+    ASSERT_EQ(table(order_book.asks)[110].size(), 2);
+    ASSERT_EQ(table(order_book.asks)[105].size(), 1);
 
     ob::Order bid1{4, ob::OrderSide::BUY, 4, 100};
     order_book.bid(bid1);
@@ -106,8 +106,8 @@ TEST_F(OrderBookTest, TestAskExecutionMultipleMatches) {
     order_book.bid(bid4);
     ob::Order bid5{8, ob::OrderSide::BUY, 3, 90};
     order_book.bid(bid5);
-    ASSERT_EQ(order_book.bids[100].size(), 2);
-    ASSERT_EQ(order_book.bids[90].size(), 3);
+    ASSERT_EQ(table(order_book.bids)[100].size(), 2);
+    ASSERT_EQ(table(order_book.bids)[90].size(), 3);
 
     ob::Order ask_should_execute{9, ob::OrderSide::SELL, 23, 80};
     order_book.ask(ask_should_execute);
@@ -132,11 +132,11 @@ TEST_F(OrderBookTest, TestAskExecutionLeftovers) {
     ob::Order ask3{3, ob::OrderSide::SELL, 6, 105};
     order_book.ask(ask3);
 
-    auto expected_asks = ob::Asks{
+    auto expected_asks = Table{
         {110, {ask1, ask2}},  // we should have these 2 orders at the same limit
         {105, {ask3}}         // and 1 order here
     };
-    ASSERT_EQ(order_book.asks, expected_asks);
+    ASSERT_EQ(table(order_book.asks), expected_asks);
 
     /**
      * Now let’s say we have got a new buy order of 8 shares at the price 107
@@ -158,25 +158,25 @@ TEST_F(OrderBookTest, TestAskExecutionLeftovers) {
 
     ob::Order bid1{4, ob::OrderSide::BUY, 2, 90};
     order_book.bid(bid1);
-    ASSERT_EQ(order_book.bids[90].size(), 1);
+    ASSERT_EQ(table(order_book.bids)[90].size(), 1);
 
-    auto expected_bids = ob::Bids{{90, {bid1}}};
-    ASSERT_EQ(order_book.bids, expected_bids);
+    auto expected_bids = Table{{90, {bid1}}};
+    ASSERT_EQ(table(order_book.bids), expected_bids);
 
     ob::Order bid_should_execute{5, ob::OrderSide::BUY, 8, 107};
     order_book.bid(bid_should_execute);
-    ASSERT_EQ(order_book.bids[107].size(), 1);
+    ASSERT_EQ(table(order_book.bids)[107].size(), 1);
 
-    auto expected_remaining_bids = ob::Bids{
+    auto expected_remaining_bids = Table{
         {107, {{5, ob::OrderSide::BUY, 2, 107}}},  // leftover bid at this limit
         {90, {bid1}}  // this one was left untouched
     };
-    ASSERT_EQ(order_book.bids, expected_remaining_bids);
+    ASSERT_EQ(table(order_book.bids), expected_remaining_bids);
 
-    auto expected_remaining_asks = ob::Asks{
+    auto expected_remaining_asks = Table{
         {110, {ask1, ask2}},  // These 2 should not have been modified
     };
-    ASSERT_EQ(order_book.asks, expected_remaining_asks);
+    ASSERT_EQ(table(order_book.asks), expected_remaining_asks);
 }
 
 }  // namespace obt
\ No newline at end of file
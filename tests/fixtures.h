@@ -1,8 +1,27 @@
 #pragma once
 
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "binary_format.h"
+#include "book_manager.h"
+#include "book_stats.h"
+#include "depth_mirror.h"
+#if defined(__linux__)
+#include "gateway.h"
+#endif
+#include "journal.h"
 #include "gtest/gtest.h"
+#include "mapped_file.h"
 #include "order_book.h"
+#include "order_parser.h"
+#include "parallel_reader.h"
+#include "pipeline.h"
 #include "spdlog/spdlog.h"
+#include "spsc_ring.h"
+#include "wire.h"
+#include "work_pool.h"
 
 namespace obt {
 class OrderBookTest : public ::testing::Test {
@@ -14,7 +33,67 @@ class OrderBookTest : public ::testing::Test {
     }
     // void TearDown() override {}
 
-    ob::OrderBook order_book;
+    ob::OrderBook<> order_book;
+};
+
+//! Same as OrderBookTest, with the flat ladder backend.
+class FlatOrderBookTest : public ::testing::Test {
+   protected:
+    void SetUp() override { spdlog::set_level(spdlog::level::debug); }
+
+    // Prices 100 to 1375, every 5
+    ob::OrderBook<ob::FlatBackend> order_book{ob::LadderConfig{100, 5, 256}};
+};
+
+//! Event sink keeping every event, to check what the book reported.
+struct RecordingSink final {
+    std::vector<ob::Trade> trades;
+    std::vector<ob::OrderAdded> added;
+    std::vector<ob::OrderCancelled> cancelled;
+    std::vector<ob::OrderReduced> reduced;
+    std::vector<std::vector<ob::LevelUpdate>> level_updates;  //!< By batch
+
+    void on_trade(ob::Trade const &e) { trades.push_back(e); }
+    void on_order_added(ob::OrderAdded const &e) { added.push_back(e); }
+    void on_order_cancelled(ob::OrderCancelled const &e) {
+        cancelled.push_back(e);
+    }
+    void on_order_reduced(ob::OrderReduced const &e) { reduced.push_back(e); }
+    void on_level_updates(ob::LevelUpdates const &e) {
+        level_updates.emplace_back(std::begin(e), std::end(e));
+    }
+};
+
+//! Same as OrderBookTest, keeping the events sent by the book.
+class EventsTest : public ::testing::Test {
+   protected:
+    ob::OrderBook<ob::MapBackend, RecordingSink> order_book;
 };
 
+//! Plain copy of a table, easy to write down in a test.
+using Table = std::map<ob::Price, std::vector<ob::Order>>;
+
+//! Copy the orders of a table, so any backend can be compared to a Table.
+template <typename Side>
+Table table(Side const &side) {
+    Table result;
+    side.for_each_limit([&result](ob::Price price, ob::Limit const &limit) {
+        result.emplace(price, std::vector<ob::Order>(std::begin(limit),
+                                                     std::end(limit)));
+    });
+    return result;
+}
+
+//! Flatten a table, best price first, so any backend can be compared.
+template <typename Table>
+std::vector<std::pair<ob::Price, std::vector<ob::Order>>> levels(
+    Table const &table) {
+    std::vector<std::pair<ob::Price, std::vector<ob::Order>>> result;
+    table.for_each_limit([&result](ob::Price price, ob::Limit const &limit) {
+        result.emplace_back(price, std::vector<ob::Order>(std::begin(limit),
+                                                          std::end(limit)));
+    });
+    return result;
+}
+
 }  // namespace obt
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+namespace obt {
+
+TEST(HistogramTest, TestSmallValuesAreExact) {
+    ob::LatencyHistogram histogram;
+    ASSERT_EQ(histogram.percentile(0.5), 0u) << "Nothing recorded";
+
+    for (std::uint64_t value = 1; value <= 50; ++value) {
+        histogram.record(value);
+    }
+    ASSERT_EQ(histogram.count(), 50u);
+    ASSERT_EQ(histogram.max(), 50u);
+    ASSERT_EQ(histogram.percentile(0), 1u);
+    ASSERT_EQ(histogram.percentile(0.5), 25u);
+    ASSERT_EQ(histogram.percentile(0.99), 50u);
+    ASSERT_EQ(histogram.percentile(1), 50u);
+}
+
+TEST(HistogramTest, TestLargeValuesAreWithinTheBucketWidth) {
+    ob::LatencyHistogram histogram;
+    for (std::uint64_t value = 1; value <= 1000000; ++value) {
+        histogram.record(value);
+    }
+
+    for (auto q : {0.5, 0.9, 0.99, 0.999}) {
+        auto const exact = q * 1000000;
+        auto const found = static_cast<double>(histogram.percentile(q));
+        ASSERT_GE(found, exact) << "q=" << q;
+        ASSERT_LE(found, exact * (1 + 1.0 / 32)) << "q=" << q;
+    }
+    ASSERT_EQ(histogram.percentile(1), 1000000u) << "Capped at the max";
+
+    // The top of the 64-bit range has a bucket too
+    histogram.record(UINT64_MAX);
+    ASSERT_EQ(histogram.percentile(1), UINT64_MAX);
+}
+
+TEST(HistogramTest, TestMerge) {
+    ob::LatencyHistogram fast;
+    ob::LatencyHistogram slow;
+    for (int i = 0; i < 99; ++i) {
+        fast.record(10);
+    }
+    slow.record(5000);
+
+    fast.merge(slow);
+    ASSERT_EQ(fast.count(), 100u);
+    ASSERT_EQ(fast.percentile(0.99), 10u);
+    ASSERT_EQ(fast.percentile(0.999), 5000u);
+    ASSERT_EQ(fast.max(), 5000u);
+}
+
+TEST(HistogramTest, TestBookStats) {
+    ob::OrderBook<ob::MapBackend, ob::NullSink, ob::BookStats> order_book;
+
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 1000};
+    ob::Order ask2{2, ob::OrderSide::SELL, 5, 1010};
+    ob::Order ask3{3, ob::OrderSide::SELL, 5, 1020};
+    ob::Order bid{4, ob::OrderSide::BUY, 12, 1020};
+    ASSERT_TRUE(order_book.place_order(ask1));
+    ASSERT_TRUE(order_book.place_order(ask2));
+    ASSERT_TRUE(order_book.place_order(ask3));
+    ASSERT_EQ(order_book.stats.levels_swept, 0u);
+
+    // Fills the first two asks, and part of the third
+    ASSERT_TRUE(order_book.place_order(bid));
+    ASSERT_EQ(order_book.stats.levels_swept, 3u);
+    ASSERT_EQ(order_book.stats.orders_filled, 2u);
+
+    ASSERT_TRUE(order_book.cancel(3));
+    ASSERT_FALSE(order_book.cancel(3));
+
+    ASSERT_EQ(order_book.stats.place.count(), 4u);
+    ASSERT_EQ(order_book.stats.cancel.count(), 2u);
+}
+
+}  // namespace obt
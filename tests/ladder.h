@@ -0,0 +1,98 @@
+#pragma once
+
+namespace obt {
+
+using Levels = std::vector<std::pair<ob::Price, std::vector<ob::Order>>>;
+
+TEST_F(FlatOrderBookTest, TestRejectPriceOutsideLadder) {
+    ob::Order below{1, ob::OrderSide::BUY, 10, 95};
+    ASSERT_FALSE(order_book.bid(below));
+    ob::Order above{2, ob::OrderSide::SELL, 10, 1380};
+    ASSERT_FALSE(order_book.ask(above));
+    ob::Order off_tick{3, ob::OrderSide::SELL, 10, 112};
+    ASSERT_FALSE(order_book.ask(off_tick));
+
+    ASSERT_TRUE(order_book.bids.empty());
+    ASSERT_TRUE(order_book.asks.empty());
+    ASSERT_TRUE(order_book.order_index.empty());
+}
+
+TEST_F(FlatOrderBookTest, TestBestPriceOrdering) {
+    ob::Order bid1{1, ob::OrderSide::BUY, 1, 100};
+    order_book.bid(bid1);
+    ob::Order bid2{2, ob::OrderSide::BUY, 2, 500};
+    order_book.bid(bid2);
+    ob::Order bid3{3, ob::OrderSide::BUY, 3, 300};
+    order_book.bid(bid3);
+    ob::Order ask1{4, ob::OrderSide::SELL, 4, 1375};
+    order_book.ask(ask1);
+    ob::Order ask2{5, ob::OrderSide::SELL, 5, 600};
+    order_book.ask(ask2);
+
+    ASSERT_EQ(order_book.bids.best_price(), 500);
+    ASSERT_EQ(order_book.asks.best_price(), 600);
+
+    auto expected_bids = Levels{{500, {bid2}}, {300, {bid3}}, {100, {bid1}}};
+    ASSERT_EQ(levels(order_book.bids), expected_bids);
+    auto expected_asks = Levels{{600, {ask2}}, {1375, {ask1}}};
+    ASSERT_EQ(levels(order_book.asks), expected_asks);
+}
+
+/**
+ * Limits far apart are in different words of the bitmap, the sweep has to
+ * jump between them.
+ */
+TEST_F(FlatOrderBookTest, TestSweepAcrossBitmapWords) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 105};
+    order_book.ask(ask1);
+    ob::Order ask2{2, ob::OrderSide::SELL, 5, 900};
+    order_book.ask(ask2);
+    ob::Order ask3{3, ob::OrderSide::SELL, 5, 1375};
+    order_book.ask(ask3);
+
+    ob::Order bid{4, ob::OrderSide::BUY, 12, 1000};
+    order_book.bid(bid);
+
+    auto expected_asks = Levels{{1375, {ask3}}};
+    ASSERT_EQ(levels(order_book.asks), expected_asks);
+    auto expected_bids = Levels{{1000, {{4, ob::OrderSide::BUY, 2, 1000}}}};
+    ASSERT_EQ(levels(order_book.bids), expected_bids);
+}
+
+TEST_F(FlatOrderBookTest, TestCancelBestLimit) {
+    ob::Order bid1{1, ob::OrderSide::BUY, 5, 400};
+    order_book.bid(bid1);
+    ob::Order bid2{2, ob::OrderSide::BUY, 5, 200};
+    order_book.bid(bid2);
+
+    ASSERT_TRUE(order_book.cancel(1));
+    ASSERT_EQ(order_book.bids.best_price(), 200);
+    ASSERT_TRUE(order_book.cancel(2));
+    ASSERT_TRUE(order_book.bids.empty());
+}
+
+/**
+ * The map backend is the reference: the same orders must leave both books in
+ * the same state.
+ */
+TEST_F(FlatOrderBookTest, TestSameResultAsMapBackend) {
+    ob::OrderBook<> reference;
+    std::vector<ob::Order> orders{
+        {1, ob::OrderSide::SELL, 5, 110}, {2, ob::OrderSide::SELL, 10, 110},
+        {3, ob::OrderSide::SELL, 6, 105}, {4, ob::OrderSide::BUY, 4, 100},
+        {5, ob::OrderSide::BUY, 6, 100},  {6, ob::OrderSide::BUY, 10, 100},
+        {7, ob::OrderSide::BUY, 8, 125},  {8, ob::OrderSide::SELL, 23, 100},
+        {9, ob::OrderSide::BUY, 3, 115},  {10, ob::OrderSide::SELL, 1, 120}};
+
+    for (auto order : orders) {
+        auto copy = order;
+        ASSERT_EQ(reference.place_order(order), order_book.place_order(copy));
+    }
+    reference.cancel(9);
+    order_book.cancel(9);
+
+    ASSERT_EQ(levels(order_book.bids), levels(reference.bids));
+    ASSERT_EQ(levels(order_book.asks), levels(reference.asks));
+}
+
+}  // namespace obt
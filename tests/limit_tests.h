@@ -0,0 +1,124 @@
+#pragma once
+
+namespace obt {
+
+TEST(LimitTest, TestFifoAndErase) {
+    ob::Limit limit;
+    auto first = limit.push_back({1, ob::OrderSide::BUY, 10, 100});
+    auto middle = limit.push_back({2, ob::OrderSide::BUY, 20, 100});
+    auto last = limit.push_back({3, ob::OrderSide::BUY, 30, 100});
+    ASSERT_EQ(limit.size(), 3);
+    ASSERT_EQ(limit.quantity(), 60);
+    ASSERT_EQ(limit.at(first).id, 1);
+    ASSERT_EQ(limit.at(middle).id, 2);
+
+    ASSERT_EQ(limit.erase(middle).quantity, 20);
+    ASSERT_EQ(limit.size(), 2);
+    ASSERT_EQ(limit.quantity(), 40);
+    ASSERT_EQ(limit.front().id, 1);
+
+    ASSERT_EQ(limit.pop_front().id, 1);
+    ASSERT_EQ(limit.front().id, 3);
+    ASSERT_EQ(limit.at(last).quantity, 30) << "Slots do not move";
+    ASSERT_EQ(limit.erase(last).id, 3);
+    ASSERT_TRUE(limit.empty());
+    ASSERT_EQ(limit.quantity(), 0);
+}
+
+TEST(LimitTest, TestFillFront) {
+    ob::Limit limit;
+    std::vector<ob::Slot> slots;
+    for (ob::OrderId id = 1; id <= 5; ++id) {
+        slots.push_back(limit.push_back({id, ob::OrderSide::SELL, 10, 100}));
+    }
+    limit.erase(slots[1]);
+    limit.erase(slots[2]);
+
+    // 1 and 4 are filled, the cancelled orders between them are skipped
+    std::vector<std::pair<ob::OrderId, ob::Quantity>> fills;
+    auto filled =
+        limit.fill_front(25, [&fills](ob::OrderId id, ob::Quantity quantity) {
+            fills.emplace_back(id, quantity);
+        });
+    ASSERT_EQ(filled, 20);
+    auto expected = std::vector<std::pair<ob::OrderId, ob::Quantity>>{
+        {1, 10}, {4, 10}};
+    ASSERT_EQ(fills, expected);
+    ASSERT_EQ(limit.size(), 1);
+    ASSERT_EQ(limit.front().id, 5);
+    ASSERT_EQ(limit.quantity(), 10);
+
+    // Not enough for the next order
+    filled = limit.fill_front(5, [](ob::OrderId, ob::Quantity) { FAIL(); });
+    ASSERT_EQ(filled, 0);
+}
+
+/**
+ * Orders added and filled at a level reuse the room of the previous ones, so
+ * once warm, a level does not allocate.
+ */
+TEST(LimitTest, TestReusesRoom) {
+    ob::Limit limit;
+    for (ob::OrderId id = 0; id < 100; ++id) {
+        limit.push_back({id, ob::OrderSide::SELL, 1, 100});
+    }
+    for (ob::OrderId id = 100; id < 1000; ++id) {
+        limit.push_back({id, ob::OrderSide::SELL, 1, 100});
+        limit.pop_front();
+    }
+    auto const capacity = limit.capacity();
+
+    for (ob::OrderId id = 1000; id < 100000; ++id) {
+        limit.push_back({id, ob::OrderSide::SELL, 1, 100});
+        limit.pop_front();
+    }
+    ASSERT_EQ(limit.capacity(), capacity);
+    ASSERT_EQ(limit.size(), 100);
+    ASSERT_EQ(limit.front().id, 99900);
+}
+
+/**
+ * An old order at the front of a level does not let cancelled orders pile
+ * up behind it: the level is packed, and the handles of the orders follow.
+ */
+TEST_F(OrderBookTest, TestCancelsBehindOldOrder) {
+    ob::Order old{1, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(old);
+    for (ob::OrderId id = 2; id < 100000; ++id) {
+        ob::Order ask{id, ob::OrderSide::SELL, 1, 110};
+        order_book.ask(ask);
+        if (id % 10 != 0) {
+            ASSERT_TRUE(order_book.cancel(id));
+        }
+    }
+    // The level keeps one order in ten, and far less room than it saw
+    auto const limit = order_book.asks.find_limit(110);
+    ASSERT_NE(limit, nullptr);
+    ASSERT_EQ(limit->size(), 1 + 99999 / 10);
+    ASSERT_LT(limit->capacity(), 99999 / 2);
+
+    // Every order can still be cancelled by ID
+    for (ob::OrderId id = 10; id < 100000; id += 10) {
+        ASSERT_TRUE(order_book.cancel(id)) << "Order " << id;
+    }
+    ASSERT_EQ(table(order_book.asks),
+              (Table{{110, {{1, ob::OrderSide::SELL, 5, 110}}}}));
+}
+
+TEST_F(OrderBookTest, TestCancelKeepsPriority) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(ask1);
+    ob::Order ask2{2, ob::OrderSide::SELL, 10, 110};
+    order_book.ask(ask2);
+    ob::Order ask3{3, ob::OrderSide::SELL, 7, 110};
+    order_book.ask(ask3);
+    order_book.cancel(ask2);
+
+    ob::Order bid{4, ob::OrderSide::BUY, 8, 110};
+    order_book.bid(bid);
+
+    auto expected_asks = Table{{110, {{3, ob::OrderSide::SELL, 4, 110}}}};
+    ASSERT_EQ(table(order_book.asks), expected_asks);
+}
+
+}  // namespace obt
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "fenwick_tree.h"
+
+namespace obt {
+
+TEST(FenwickTreeTest, TestPrefixSums) {
+    ob::FenwickTree tree(10);
+    ASSERT_EQ(tree.size(), 10u);
+    ASSERT_EQ(tree.prefix(10), 0);
+
+    for (std::size_t i = 0; i < 10; ++i) {
+        tree.add(i, static_cast<std::int64_t>(i + 1));
+    }
+    ASSERT_EQ(tree.prefix(0), 0);
+    ASSERT_EQ(tree.prefix(1), 1);
+    ASSERT_EQ(tree.prefix(4), 1 + 2 + 3 + 4);
+    ASSERT_EQ(tree.prefix(10), 55);
+
+    tree.add(3, -4);
+    ASSERT_EQ(tree.prefix(3), 6);
+    ASSERT_EQ(tree.prefix(4), 6);
+    ASSERT_EQ(tree.prefix(10), 51);
+}
+
+TEST(FenwickTreeTest, TestLastAtMost) {
+    // Values 0 5 0 0 3 2 0
+    ob::FenwickTree tree(7);
+    tree.add(1, 5);
+    tree.add(4, 3);
+    tree.add(5, 2);
+
+    ASSERT_EQ(tree.last_at_most(-1), 0u);
+    ASSERT_EQ(tree.last_at_most(0), 1u) << "Index 1 takes the sum past 0";
+    ASSERT_EQ(tree.last_at_most(4), 1u);
+    ASSERT_EQ(tree.last_at_most(5), 4u) << "Zeros are skipped";
+    ASSERT_EQ(tree.last_at_most(7), 4u);
+    ASSERT_EQ(tree.last_at_most(8), 5u);
+    ASSERT_EQ(tree.last_at_most(10), 7u) << "The whole tree";
+}
+
+TEST_F(FlatOrderBookTest, TestQuantityUntil) {
+    for (ob::OrderId id = 1; id <= 3; ++id) {
+        ob::Order bid{id, ob::OrderSide::BUY, 10 * id, 100 + 5 * id};
+        order_book.bid(bid);
+        ob::Order ask{id + 3, ob::OrderSide::SELL, 10 * id, 200 + 5 * id};
+        order_book.ask(ask);
+    }
+
+    // Bids 10@105, 20@110, 30@115; asks 10@205, 20@210, 30@215
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 115), 30);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 108), 50);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 100), 60);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 0), 60);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 120), 0);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 5000), 0);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 205), 10);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 212), 30);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 5000), 60);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 200), 0);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 0), 0);
+
+    // Fills and cancels are seen
+    ob::Order sell{7, ob::OrderSide::SELL, 35, 110};
+    order_book.ask(sell);
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 100), 25);
+    ASSERT_TRUE(order_book.cancel(1));
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::BUY, 100), 15);
+}
+
+TEST_F(FlatOrderBookTest, TestEstimateFill) {
+    for (ob::OrderId id = 1; id <= 3; ++id) {
+        ob::Order ask{id, ob::OrderSide::SELL, 10 * id, 200 + 5 * id};
+        order_book.ask(ask);
+    }
+
+    // 10@205, then 15 of the 20@210
+    ob::FillEstimate fill{};
+    ASSERT_TRUE(order_book.estimate_fill(ob::OrderSide::SELL, 25, fill));
+    ASSERT_EQ(fill.worst_price, 210);
+    ASSERT_EQ(fill.quantity, 25);
+    ASSERT_EQ(fill.notional, 10 * 205 + 15 * 210);
+    ASSERT_DOUBLE_EQ(fill.vwap(), (10.0 * 205 + 15.0 * 210) / 25);
+
+    ASSERT_TRUE(order_book.estimate_fill(ob::OrderSide::SELL, 10, fill));
+    ASSERT_EQ(fill.worst_price, 205) << "The best level is exactly enough";
+    ASSERT_TRUE(order_book.estimate_fill(ob::OrderSide::SELL, 60, fill));
+    ASSERT_EQ(fill.worst_price, 215);
+    ASSERT_FALSE(order_book.estimate_fill(ob::OrderSide::SELL, 61, fill));
+    ASSERT_FALSE(order_book.estimate_fill(ob::OrderSide::SELL, 0, fill));
+    ASSERT_FALSE(order_book.estimate_fill(ob::OrderSide::BUY, 1, fill));
+
+    // Nothing was traded
+    ASSERT_EQ(order_book.quantity_until(ob::OrderSide::SELL, 5000), 60);
+}
+
+//! Compare the liquidity queries of two books holding the same orders.
+template <typename Book, typename Other>
+void expect_same_liquidity(Book const &book, Other const &other) {
+    for (ob::Price price = 90; price <= 1400; price += 5) {
+        for (auto side : {ob::OrderSide::BUY, ob::OrderSide::SELL}) {
+            ASSERT_EQ(book.quantity_until(side, price),
+                      other.quantity_until(side, price))
+                << "Price " << price;
+        }
+    }
+    for (std::int64_t quantity = 1; quantity <= 2000; quantity += 7) {
+        for (auto side : {ob::OrderSide::BUY, ob::OrderSide::SELL}) {
+            ob::FillEstimate fill{};
+            ob::FillEstimate other_fill{};
+            auto const found = book.estimate_fill(side, quantity, fill);
+            ASSERT_EQ(found, other.estimate_fill(side, quantity, other_fill))
+                << "Quantity " << quantity;
+            if (found) {
+                ASSERT_EQ(fill.worst_price, other_fill.worst_price);
+                ASSERT_EQ(fill.notional, other_fill.notional);
+            }
+        }
+    }
+}
+
+/**
+ * The flat backend answers from its trees, the map backend walks its levels:
+ * both must agree after trades, cancels, amends and a snapshot load.
+ */
+TEST_F(FlatOrderBookTest, TestLiquidityMatchesMapBackend) {
+    spdlog::set_level(spdlog::level::critical);
+    ob::OrderBook<> reference;
+    for (ob::OrderId id = 1; id <= 2000; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        auto const price = static_cast<ob::Price>(600 + 5 * ((id * 37) % 41));
+        ob::Order order{id, side, id % 13 + 1, price};
+        if (id % 5 == 0) {
+            ASSERT_EQ(order_book.cancel(id - 3), reference.cancel(id - 3));
+        } else if (id % 7 == 0) {
+            ob::Order amended{id - 6, ob::OrderSide::BUY, id % 4 + 1, 600};
+            auto copy = amended;
+            ASSERT_EQ(order_book.amend(amended), reference.amend(copy));
+        } else {
+            auto copy = order;
+            order_book.place_order(order);
+            reference.place_order(copy);
+        }
+        if (id % 250 == 0) {
+            expect_same_liquidity(order_book, reference);
+        }
+    }
+    ASSERT_FALSE(order_book.bids.empty());
+    ASSERT_FALSE(order_book.asks.empty());
+
+    std::ostringstream stream(std::ios::binary);
+    order_book.save_snapshot(stream);
+    ob::OrderBook<ob::FlatBackend> restored{ob::LadderConfig{100, 5, 256}};
+    ASSERT_TRUE(restored.load_snapshot(stream.str()));
+    expect_same_liquidity(restored, reference);
+}
+
+}  // namespace obt
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <string>
+
+namespace obt {
+
+/**
+ * Each symbol must end up in its own book, in the same state as if its orders
+ * were matched alone, whatever the number of shards.
+ */
+TEST(BookManagerTest, TestBooksPerSymbol) {
+    spdlog::set_level(spdlog::level::critical);
+
+    std::vector<std::string> symbols{"AAA", "BBB", "CCC", "DDD", "EEE"};
+    std::map<std::string, ob::OrderBook<>> expected;
+    ob::ManagerConfig config;
+    config.shards = 2;
+    config.pin_threads = false;
+    config.batch_size = 7;
+    ob::BookManager<> manager(config);
+
+    for (ob::OrderId id = 1; id <= 500; ++id) {
+        auto const &symbol = symbols[static_cast<std::size_t>(id * 7) % 5];
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 9 + 1, 1000 + (id * 37) % 50};
+        auto const type =
+            id % 5 == 0 ? ob::OrderType::CANCEL : ob::OrderType::NEW;
+        if (type == ob::OrderType::CANCEL) {
+            order.id = id - 3;
+        }
+
+        manager.submit(symbol, type, order);
+        auto &book = expected[symbol];
+        if (type == ob::OrderType::NEW) {
+            book.place_order(order);
+        } else {
+            book.cancel(order);
+        }
+    }
+    manager.stop();
+
+    ASSERT_EQ(manager.symbol_count(), symbols.size());
+    std::vector<std::string> seen;
+    manager.for_each_book([&](std::string const &symbol, auto const &book) {
+        seen.push_back(symbol);
+        ASSERT_EQ(table(book.bids), table(expected[symbol].bids)) << symbol;
+        ASSERT_EQ(table(book.asks), table(expected[symbol].asks)) << symbol;
+    });
+    ASSERT_EQ(seen.size(), symbols.size());
+}
+
+/**
+ * Orders without a symbol all go to the same book.
+ */
+TEST(BookManagerTest, TestEmptySymbol) {
+    ob::ManagerConfig config;
+    config.shards = 3;
+    config.pin_threads = false;
+    ob::BookManager<> manager(config);
+
+    manager.submit("", ob::OrderType::NEW, {1, ob::OrderSide::SELL, 5, 100});
+    manager.submit("", ob::OrderType::NEW, {2, ob::OrderSide::BUY, 2, 100});
+    manager.stop();
+    manager.stop();  // Stopping twice is harmless
+
+    ASSERT_EQ(manager.symbol_count(), 1);
+    manager.for_each_book([](std::string const &symbol, auto const &book) {
+        ASSERT_EQ(symbol, "");
+        ASSERT_EQ(table(book.asks),
+                  (Table{{100, {{1, ob::OrderSide::SELL, 3, 100}}}}));
+        ASSERT_TRUE(book.bids.empty());
+    });
+}
+
+/**
+ * Waiting lets the books be read while the workers keep running.
+ */
+TEST(BookManagerTest, TestWait) {
+    ob::ManagerConfig config;
+    config.shards = 2;
+    config.pin_threads = false;
+    ob::BookManager<> manager(config);
+
+    manager.submit("AAA", ob::OrderType::NEW, {1, ob::OrderSide::SELL, 5, 100});
+    manager.submit("BBB", ob::OrderType::NEW, {2, ob::OrderSide::BUY, 2, 90});
+    manager.wait();
+    std::size_t resting = 0;
+    manager.for_each_book([&resting](std::string const &, auto const &book) {
+        resting += book.order_index.size();
+    });
+    ASSERT_EQ(resting, 2);
+
+    manager.submit("AAA", ob::OrderType::CANCEL, {1, ob::OrderSide::SELL});
+    manager.wait();
+    manager.for_each_book([](std::string const &symbol, auto const &book) {
+        ASSERT_EQ(book.order_index.size(), symbol == "AAA" ? 0u : 1u);
+    });
+    manager.stop();
+    manager.wait();  // Nothing left to wait for
+}
+
+/**
+ * A sink that can be built from a symbol is built from the symbol of its
+ * book, so that logs say which book an event came from.
+ */
+TEST(BookManagerTest, TestSinkSymbols) {
+    spdlog::set_level(spdlog::level::critical);
+    ob::ManagerConfig config;
+    config.shards = 3;
+    config.pin_threads = false;
+    config.batch_size = 2;
+    ob::BookManager<ob::MapBackend, ob::LogSink> manager(config);
+
+    for (ob::OrderId id = 1; id <= 40; ++id) {
+        manager.submit("S" + std::to_string(id % 10), ob::OrderType::NEW,
+                       {id, ob::OrderSide::BUY, 1, 100});
+    }
+    manager.stop();
+
+    ASSERT_EQ(manager.symbol_count(), 10);
+    manager.for_each_book([](std::string const &symbol, auto const &book) {
+        ASSERT_EQ(book.sink.prefix, symbol + ": ");
+        ASSERT_EQ(book.order_index.size(), 4) << symbol;
+    });
+    ASSERT_EQ(ob::LogSink().prefix, "") << "No symbol, no prefix";
+}
+
+}  // namespace obt
@@ -10,12 +10,26 @@ TEST_F(OrderBookTest, TestAddOrders) {
     ob::Order order_sell{2, ob::OrderSide::SELL, 10, ask_price};
 
     order_book.bid(order_buy);
-    auto expected_bids = ob::Bids{{bid_price, {order_buy}}};
-    ASSERT_EQ(order_book.bids, expected_bids);
+    auto expected_bids = Table{{bid_price, {order_buy}}};
+    ASSERT_EQ(table(order_book.bids), expected_bids);
 
     order_book.ask(order_sell);
-    auto expected_asks = ob::Asks{{ask_price, {order_sell}}};
-    ASSERT_EQ(order_book.asks, expected_asks);
+    auto expected_asks = Table{{ask_price, {order_sell}}};
+    ASSERT_EQ(table(order_book.asks), expected_asks);
+}
+
+TEST_F(OrderBookTest, TestRejectDuplicateId) {
+    ob::Order order_buy{1, ob::OrderSide::BUY, 10, 5};
+    ASSERT_TRUE(order_book.bid(order_buy));
+
+    ob::Order duplicate_buy{1, ob::OrderSide::BUY, 3, 4};
+    ASSERT_FALSE(order_book.bid(duplicate_buy));
+    ob::Order duplicate_sell{1, ob::OrderSide::SELL, 3, 20};
+    ASSERT_FALSE(order_book.place_order(duplicate_sell));
+
+    auto expected_bids = Table{{5, {order_buy}}};
+    ASSERT_EQ(table(order_book.bids), expected_bids);
+    ASSERT_TRUE(order_book.asks.empty());
 }
 
 }
\ No newline at end of file
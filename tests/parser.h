@@ -0,0 +1,213 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace obt {
+
+using TypedOrders = std::vector<std::pair<ob::OrderType, ob::Order>>;
+
+TEST(ParserTest, TestParseOrders) {
+    auto parsed = ob::parse_orders(
+        "A,100000,S,1,1075\n"
+        "A,100001,B,9,1000\r\n"
+        "X,100000,S,1,1075");
+
+    auto expected = TypedOrders{
+        {ob::OrderType::NEW, {100000, ob::OrderSide::SELL, 1, 1075}},
+        {ob::OrderType::NEW, {100001, ob::OrderSide::BUY, 9, 1000}},
+        {ob::OrderType::CANCEL, {100000, ob::OrderSide::SELL, 1, 1075}}};
+    ASSERT_EQ(parsed.orders, expected);
+    ASSERT_TRUE(parsed.errors.empty());
+}
+
+TEST(ParserTest, TestMalformedLines) {
+    std::string text =
+        "A,1,S,1,1075\n"    // offset 0, valid
+        "A,2,B,9\n"         // offset 13, missing the price
+        "Z,3,B,9,1000\n"    // offset 21, unknown type
+        "A,4,Q,9,1000\n"    // offset 34, unknown side
+        "A,5,B,9x,1000\n"   // offset 47, bad quantity
+        "\n"                // offset 61, empty lines are skipped
+        "A,6,B,9,1000,7\n"  // offset 62, too many fields
+        "A,7,B,2,900\n";    // offset 77, valid
+    auto parsed = ob::parse_orders(text);
+
+    ASSERT_EQ(parsed.orders.size(), 2);
+    ASSERT_EQ(parsed.orders[0].second.id, 1);
+    ASSERT_EQ(parsed.orders[1].second.id, 7);
+
+    std::vector<std::size_t> offsets;
+    for (auto const &error : parsed.errors) {
+        offsets.push_back(error.offset);
+    }
+    ASSERT_EQ(offsets, (std::vector<std::size_t>{13, 21, 34, 47, 62}));
+}
+
+/**
+ * Fields and lines longer than a SIMD block must be found too.
+ */
+TEST(ParserTest, TestLongLines) {
+    auto parsed = ob::parse_orders(
+        "A,0000000000000000001,B,00000000000000000000007,0000000000000000125\n"
+        "A,2,S,3,4");
+
+    auto expected =
+        TypedOrders{{ob::OrderType::NEW, {1, ob::OrderSide::BUY, 7, 125}},
+                    {ob::OrderType::NEW, {2, ob::OrderSide::SELL, 3, 4}}};
+    ASSERT_EQ(parsed.orders, expected);
+}
+
+TEST(ParserTest, TestReaderStreamsLines) {
+    std::string text = "A,1,S,1,1075\n\nA,2,B\nX,1,S,1,1075\n";
+    ob::OrderReader reader(text);
+    ob::ParsedLine line;
+
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_EQ(line.type, ob::OrderType::NEW);
+    ASSERT_EQ(line.order, (ob::Order{1, ob::OrderSide::SELL, 1, 1075}));
+    ASSERT_EQ(reader.offset(), 13) << "Only the first line was read";
+
+    // The empty line is skipped
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_NE(line.error, nullptr);
+    ASSERT_EQ(line.offset, 14);
+
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_EQ(line.type, ob::OrderType::CANCEL);
+
+    ASSERT_FALSE(reader.next(line));
+    ASSERT_EQ(reader.offset(), text.size());
+}
+
+TEST(ParserTest, TestSymbolField) {
+    std::string text = "A,AAPL,1,S,1,1075\nA,2,B,9,1000\nA,,3,B,9,1000\n";
+    ob::OrderReader reader(text);
+    ob::ParsedLine line;
+
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_EQ(line.symbol, "AAPL");
+    ASSERT_EQ(line.order, (ob::Order{1, ob::OrderSide::SELL, 1, 1075}));
+
+    // Lines without a symbol are still valid
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_TRUE(line.symbol.empty());
+    ASSERT_EQ(line.order.id, 2);
+
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_NE(line.error, nullptr) << "A symbol field cannot be empty";
+}
+
+TEST(ParserTest, TestForEachOrder) {
+    std::vector<ob::OrderId> ids;
+    std::vector<std::size_t> offsets;
+    ob::for_each_order(
+        "A,1,S,1,1075\nA,2\nA,3,B,1,1000",
+        [&ids](ob::OrderType, ob::Order const &order) {
+            ids.push_back(order.id);
+        },
+        [&offsets](ob::ParseError const &error) {
+            offsets.push_back(error.offset);
+        });
+
+    ASSERT_EQ(ids, (std::vector<ob::OrderId>{1, 3}));
+    ASSERT_EQ(offsets, (std::vector<std::size_t>{13}));
+}
+
+TEST(ParserTest, TestMappedFile) {
+    auto path = std::filesystem::temp_directory_path() / "ob_parser_test.csv";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "A,1,S,1,1075\nX,1,S,1,1075\n";
+    }
+
+    {
+        ob::MappedFile file(path.string());
+        ASSERT_TRUE(file);
+        auto parsed = ob::parse_orders(file.view());
+        ASSERT_EQ(parsed.orders.size(), 2);
+
+        // The contents can still be read after being discarded
+        file.discard(file.view().size());
+        ASSERT_EQ(ob::parse_orders(file.view()).orders, parsed.orders);
+    }
+    std::filesystem::remove(path);
+
+    ob::MappedFile missing(path.string());
+    ASSERT_FALSE(missing);
+}
+
+//! Every line of a text, read by an OrderReader.
+std::vector<ob::ParsedLine> read_lines(std::string_view text) {
+    std::vector<ob::ParsedLine> lines;
+    ob::OrderReader reader(text);
+    for (ob::ParsedLine line; reader.next(line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * Whatever the chunk size and the number of threads, the batches hold the
+ * same lines as a single reader, in the same order.
+ */
+TEST(ParserTest, TestParallelReader) {
+    std::string text;
+    for (int i = 1; i <= 2000; ++i) {
+        auto const id = std::to_string(i);
+        switch (i % 5) {
+            case 0:
+                text += "A," + id + ",S,1,1075\r\n";
+                break;
+            case 1:
+                text += "A,AAPL," + id + ",B,9,1000,IOC\n\n";
+                break;
+            case 2:
+                text += "X," + id + ",B\n";
+                break;
+            default:
+                text += "A," + id + ",B," + id + ",975\n";
+        }
+    }
+    text += "A,2001,S,1,1075";
+    auto const expected = read_lines(text);
+
+    for (std::size_t threads : {1, 3}) {
+        for (std::size_t chunk_size : {1, 7, 100, 1 << 20}) {
+            ob::ParallelOrderReader reader(text, threads, chunk_size);
+            std::vector<ob::ParsedLine> lines;
+            std::size_t offset = 0;
+            while (auto const batch = reader.next()) {
+                lines.insert(std::end(lines), std::begin(*batch),
+                             std::end(*batch));
+                ASSERT_GT(reader.offset(), offset);
+                offset = reader.offset();
+            }
+            ASSERT_EQ(reader.offset(), text.size());
+            ASSERT_EQ(reader.next(), nullptr);
+
+            ASSERT_EQ(lines.size(), expected.size());
+            for (std::size_t i = 0; i < lines.size(); ++i) {
+                ASSERT_EQ(lines[i].offset, expected[i].offset);
+                ASSERT_EQ(lines[i].error, expected[i].error);
+                if (lines[i].error == nullptr) {
+                    ASSERT_EQ(lines[i].type, expected[i].type);
+                    ASSERT_EQ(lines[i].symbol, expected[i].symbol);
+                    ASSERT_EQ(lines[i].order, expected[i].order);
+                }
+            }
+        }
+    }
+
+    ob::ParallelOrderReader empty("", 2);
+    ASSERT_EQ(empty.next(), nullptr);
+}
+
+}  // namespace obt
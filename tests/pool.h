@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace obt {
+
+TEST(WorkPoolTest, TestRunsEveryTask) {
+    ob::WorkPool pool(3);
+    ASSERT_EQ(pool.thread_count(), 3u);
+
+    std::vector<int> results(1000);
+    for (int i = 0; i < 1000; ++i) {
+        pool.submit([&results, i] { results[i] = i * i; });
+    }
+    pool.wait();
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(results[i], i * i);
+    }
+
+    // The pool can be used again
+    std::atomic<int> count{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.submit([&count] { ++count; });
+    }
+    pool.wait();
+    ASSERT_EQ(count, 10);
+}
+
+/**
+ * The first task blocks its thread until every other task ran, including
+ * those queued behind it: the other thread must steal them.
+ */
+TEST(WorkPoolTest, TestStealsFromBusyThread) {
+    ob::WorkPool pool(2);
+    constexpr int tasks = 100;
+    std::atomic<int> done{0};
+    pool.submit([&done] {
+        while (done.load() < tasks - 1) {
+            std::this_thread::yield();
+        }
+    });
+    for (int i = 1; i < tasks; ++i) {
+        pool.submit([&done] { ++done; });
+    }
+    pool.wait();
+    ASSERT_EQ(done, tasks - 1);
+}
+
+TEST(WorkPoolTest, TestTasksSubmitTasks) {
+    std::atomic<int> count{0};
+    {
+        ob::WorkPool pool(2);
+        pool.submit([&pool, &count] {
+            for (int i = 0; i < 50; ++i) {
+                pool.submit([&count] { ++count; });
+            }
+        });
+        pool.wait();
+        ASSERT_EQ(count, 50);
+
+        // Queued tasks still run when the pool is destroyed
+        for (int i = 0; i < 50; ++i) {
+            pool.submit([&count] { ++count; });
+        }
+    }
+    ASSERT_EQ(count, 100);
+}
+
+}  // namespace obt
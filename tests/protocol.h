@@ -0,0 +1,129 @@
+#pragma once
+
+#include <vector>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace obt {
+
+TEST(WireTest, TestRequests) {
+    // Requests are the records of the binary files
+    ob::Order order{42, ob::OrderSide::SELL, 7, 1075, ob::TimeInForce::IOC};
+    char request[ob::wire::request_size];
+    ob::binary::encode(request, ob::OrderType::CANCEL, order);
+
+    ob::binary::Record record{};
+    ASSERT_TRUE(ob::binary::decode(request, record));
+    ASSERT_EQ(record.type, ob::OrderType::CANCEL);
+    ASSERT_EQ(record.order, order);
+    ASSERT_EQ(record.order.time_in_force, ob::TimeInForce::IOC);
+
+    request[0] = 'Z';
+    ASSERT_FALSE(ob::binary::decode(request, record));
+}
+
+TEST(WireTest, TestReports) {
+    std::vector<ob::wire::Report> reports{
+        {ob::wire::ReportKind::ACCEPTED, ob::OrderSide::BUY, 1, 10, 1000, 0,
+         0},
+        {ob::wire::ReportKind::FILL, ob::OrderSide::SELL, 2, 3, 990, 1, 4},
+        {ob::wire::ReportKind::REJECTED, ob::OrderSide::BUY, -5, 0, 0, 0, 0}};
+
+    std::vector<char> data(reports.size() * ob::wire::report_size);
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+        ob::wire::encode(data.data() + i * ob::wire::report_size, reports[i]);
+    }
+    ASSERT_EQ(data[ob::wire::report_size], 'F');
+    ASSERT_EQ(data[ob::wire::report_size + 1], 'S');
+
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+        ob::wire::Report report{};
+        ASSERT_TRUE(ob::wire::decode(data.data() + i * ob::wire::report_size,
+                                     report));
+        ASSERT_EQ(report.kind, reports[i].kind);
+        ASSERT_EQ(report.side, reports[i].side);
+        ASSERT_EQ(report.id, reports[i].id);
+        ASSERT_EQ(report.quantity, reports[i].quantity);
+        ASSERT_EQ(report.price, reports[i].price);
+        ASSERT_EQ(report.other_id, reports[i].other_id);
+        ASSERT_EQ(report.remaining, reports[i].remaining);
+    }
+
+    ob::wire::Report report{};
+    data[0] = 'Q';
+    ASSERT_FALSE(ob::wire::decode(data.data(), report)) << "Unknown kind";
+    data[0] = 'A';
+    data[1] = 'Q';
+    ASSERT_FALSE(ob::wire::decode(data.data(), report)) << "Unknown side";
+}
+
+#if defined(__linux__)
+
+/**
+ * A client that hangs up is dropped, while its orders stay in the book. Its
+ * last event carries EPOLLIN and EPOLLOUT together.
+ */
+TEST(GatewayTest, TestDisconnect) {
+    auto const listener = ob::listen_on(0);
+    ASSERT_GE(listener, 0);
+    sockaddr_in address{};
+    socklen_t length = sizeof(address);
+    ::getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length);
+
+    auto const epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    ASSERT_GE(epoll, 0);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = 0;
+    ASSERT_EQ(::epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event), 0);
+
+    {
+        ob::Gateway gateway(listener, epoll);
+        auto const client = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ASSERT_GE(client, 0);
+        ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr *>(&address),
+                            sizeof(address)),
+                  0);
+        for (int i = 0; i < 100 && gateway.connection_count() == 0; ++i) {
+            ASSERT_TRUE(gateway.poll(10));
+        }
+        ASSERT_EQ(gateway.connection_count(), 1);
+
+        // One order, acknowledged
+        char request[ob::wire::request_size];
+        ob::binary::encode(request, ob::OrderType::NEW,
+                           {1, ob::OrderSide::BUY, 5, 100});
+        ASSERT_EQ(::write(client, request, sizeof(request)),
+                  static_cast<ssize_t>(sizeof(request)));
+        for (int i = 0; i < 100 && gateway.book().order_index.empty(); ++i) {
+            ASSERT_TRUE(gateway.poll(10));
+        }
+        char data[ob::wire::report_size];
+        ASSERT_EQ(::recv(client, data, sizeof(data), MSG_WAITALL),
+                  static_cast<ssize_t>(sizeof(data)));
+        ob::wire::Report report{};
+        ASSERT_TRUE(ob::wire::decode(data, report));
+        ASSERT_EQ(report.kind, ob::wire::ReportKind::ACCEPTED);
+        ASSERT_EQ(report.id, 1);
+        ASSERT_EQ(report.quantity, 5);
+
+        ::close(client);
+        for (int i = 0; i < 100 && gateway.connection_count() != 0; ++i) {
+            ASSERT_TRUE(gateway.poll(10));
+        }
+        ASSERT_EQ(gateway.connection_count(), 0);
+        ASSERT_EQ(gateway.book().order_index.size(), 1);
+    }
+    ::close(epoll);
+    ::close(listener);
+}
+
+#endif
+
+}  // namespace obt
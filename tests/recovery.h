@@ -0,0 +1,98 @@
+#pragma once
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace obt {
+
+//! Whole contents of a file.
+inline std::string read_file(std::filesystem::path const &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file),
+                       std::istreambuf_iterator<char>());
+}
+
+TEST(JournalTest, TestGroupCommit) {
+    auto path = std::filesystem::temp_directory_path() / "ob_journal_test";
+    std::filesystem::remove(path);
+    {
+        ob::journal::WriterConfig config;
+        config.batch_size = 64;
+        ob::journal::Writer writer(path.string(), config);
+        ASSERT_TRUE(writer);
+        for (ob::OrderId id = 1; id <= 1000; ++id) {
+            auto const type =
+                id % 3 ? ob::OrderType::NEW : ob::OrderType::CANCEL;
+            ASSERT_EQ(writer.append(type, {id, ob::OrderSide::BUY, id, 5}),
+                      static_cast<std::uint64_t>(id));
+        }
+        writer.wait_durable(10);
+        ASSERT_GE(writer.durable(), 10);
+        ASSERT_TRUE(writer.sync());
+        ASSERT_EQ(writer.durable(), 1000);
+        ASSERT_EQ(writer.stats().entries, 1000);
+        ASSERT_LT(writer.stats().syncs, 1000) << "Entries were batched";
+    }
+
+    auto const data = read_file(path);
+    ob::journal::Reader reader(data);
+    ASSERT_EQ(reader.error(), nullptr);
+    ASSERT_FALSE(reader.torn());
+    ASSERT_EQ(reader.size(), 1000);
+    auto const entry = reader.read(299);
+    ASSERT_EQ(entry.sequence, 300);
+    ASSERT_EQ(entry.type, ob::OrderType::CANCEL);
+    ASSERT_EQ(entry.order, (ob::Order{300, ob::OrderSide::BUY, 300, 5}));
+
+    std::filesystem::remove(path);
+}
+
+/**
+ * After a crash in the middle of an entry, the journal is read up to the
+ * last complete entry, and continued from there.
+ */
+TEST(JournalTest, TestTornEnd) {
+    auto path = std::filesystem::temp_directory_path() / "ob_journal_torn";
+    std::filesystem::remove(path);
+    ob::journal::WriterConfig config;
+    config.group_commit = false;
+    {
+        ob::journal::Writer writer(path.string(), config);
+        writer.append(ob::OrderType::NEW, {1, ob::OrderSide::SELL, 2, 10});
+        writer.append(ob::OrderType::NEW, {2, ob::OrderSide::SELL, 2, 10});
+        ASSERT_EQ(writer.durable(), 2);
+        ASSERT_EQ(writer.stats().syncs, 2);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+    {
+        auto const data = read_file(path);
+        ob::journal::Reader reader(data);
+        ASSERT_TRUE(reader.torn());
+        ASSERT_EQ(reader.size(), 1);
+    }
+
+    {
+        ob::journal::Writer writer(path.string(), config);
+        ASSERT_EQ(writer.durable(), 1);
+        ASSERT_EQ(
+            writer.append(ob::OrderType::NEW, {3, ob::OrderSide::BUY, 2, 10}),
+            2);
+    }
+
+    auto data = read_file(path);
+    ob::journal::Reader reader(data);
+    ASSERT_FALSE(reader.torn());
+    ASSERT_EQ(reader.size(), 2);
+    ASSERT_EQ(reader.read(1).order.id, 3);
+
+    // A corrupted entry ends the journal
+    data[ob::journal::Reader::offset(1) + 13] ^= 1;
+    ASSERT_EQ(ob::journal::Reader(data).size(), 1);
+
+    std::filesystem::remove(path);
+}
+
+}  // namespace obt
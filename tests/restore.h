@@ -0,0 +1,148 @@
+#pragma once
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+namespace obt {
+
+//! Write a snapshot of a book to a string.
+template <typename Book>
+std::string save(Book const &book) {
+    std::ostringstream stream(std::ios::binary);
+    book.save_snapshot(stream);
+    return stream.str();
+}
+
+TEST_F(EventsTest, TestSnapshotRoundTrip) {
+    spdlog::set_level(spdlog::level::critical);
+    for (ob::OrderId id = 1; id <= 500; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 9 + 1, 1000 + (id * 37) % 50};
+        order_book.place_order(order);
+    }
+    auto const data = save(order_book);
+
+    ob::OrderBook<ob::MapBackend, RecordingSink> restored;
+    ASSERT_TRUE(restored.load_snapshot(data));
+    ASSERT_EQ(table(restored.bids), table(order_book.bids));
+    ASSERT_EQ(table(restored.asks), table(order_book.asks));
+    ASSERT_EQ(restored.sequence(), order_book.sequence());
+    ASSERT_TRUE(restored.sink.added.empty()) << "Loading sends no events";
+
+    // Both books go on the same way, orders can be found by ID
+    for (ob::OrderId id = 501; id <= 700; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 9 + 1, 1000 + (id * 37) % 50};
+        if (id % 3 == 0) {
+            ASSERT_EQ(order_book.cancel(id - 400), restored.cancel(id - 400));
+        } else {
+            auto copy = order;
+            order_book.place_order(order);
+            restored.place_order(copy);
+        }
+    }
+    ASSERT_EQ(table(restored.bids), table(order_book.bids));
+    ASSERT_EQ(table(restored.asks), table(order_book.asks));
+    ASSERT_EQ(restored.sequence(), order_book.sequence());
+
+    ASSERT_EQ(save(restored), save(order_book));
+}
+
+TEST_F(OrderBookTest, TestSnapshotRejected) {
+    spdlog::set_level(spdlog::level::critical);
+    ob::Order bid{1, ob::OrderSide::BUY, 10, 50};
+    order_book.bid(bid);
+    ob::Order ask{2, ob::OrderSide::SELL, 3, 2000};
+    order_book.ask(ask);
+    auto data = save(order_book);
+
+    ASSERT_FALSE(order_book.load_snapshot(data)) << "The book is not empty";
+
+    // Prices outside of a flat ladder
+    ob::OrderBook<ob::FlatBackend> flat{ob::LadderConfig{100, 5, 256}};
+    ASSERT_FALSE(flat.load_snapshot(data));
+    ASSERT_TRUE(flat.bids.empty());
+    ASSERT_TRUE(flat.asks.empty());
+
+    // Any corruption is detected
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        auto corrupted = data;
+        corrupted[i] = static_cast<char>(corrupted[i] ^ 0x10);
+        ob::OrderBook<> book;
+        ASSERT_FALSE(book.load_snapshot(corrupted)) << "Byte " << i;
+    }
+    ob::OrderBook<> truncated;
+    ASSERT_FALSE(truncated.load_snapshot(data.substr(0, data.size() - 1)));
+}
+
+/**
+ * A snapshot records the last journal entry in the book, so that recovering
+ * from it and the journal does not apply the entries before it twice.
+ */
+TEST(JournalTest, TestSnapshotMidJournal) {
+    spdlog::set_level(spdlog::level::critical);
+    auto path = std::filesystem::temp_directory_path() / "ob_journal_snap";
+    std::filesystem::remove(path);
+
+    auto apply = [](ob::OrderBook<> &book, ob::OrderType type,
+                    ob::Order order) {
+        switch (type) {
+            case ob::OrderType::NEW:
+                book.place_order(order);
+                break;
+            case ob::OrderType::CANCEL:
+                book.cancel(order);
+                break;
+            case ob::OrderType::MODIFY:
+                book.amend(order);
+                break;
+        }
+    };
+
+    // A clean run journals every message, and is saved half way through
+    ob::OrderBook<> clean;
+    std::string data;
+    {
+        ob::journal::Writer writer(path.string());
+        ASSERT_TRUE(writer);
+        for (ob::OrderId id = 1; id <= 600; ++id) {
+            auto const side =
+                id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+            auto const type =
+                id % 4 == 0 ? ob::OrderType::CANCEL : ob::OrderType::NEW;
+            ob::Order order{type == ob::OrderType::NEW ? id : id - 3, side,
+                            id % 9 + 1, 1000 + (id * 37) % 50};
+            writer.append(type, order);
+            apply(clean, type, order);
+            if (id == 300) {
+                std::ostringstream stream(std::ios::binary);
+                clean.save_snapshot(stream, 300);
+                data = stream.str();
+            }
+        }
+        ASSERT_TRUE(writer.sync());
+    }
+
+    ob::snapshot::Reader snapshot(data);
+    ASSERT_EQ(snapshot.error(), nullptr);
+    ASSERT_EQ(snapshot.journal(), 300);
+
+    // Recovery replays the journal after the snapshot only
+    ob::OrderBook<> recovered;
+    ASSERT_TRUE(recovered.load_snapshot(data));
+    auto const journal = read_file(path);
+    ob::journal::Reader reader(journal);
+    ASSERT_EQ(reader.size(), 600);
+    for (auto i = snapshot.journal(); i < reader.size(); ++i) {
+        auto const entry = reader.read(i);
+        apply(recovered, entry.type, entry.order);
+    }
+    ASSERT_EQ(table(recovered.bids), table(clean.bids));
+    ASSERT_EQ(table(recovered.asks), table(clean.asks));
+    ASSERT_EQ(save(recovered), save(clean));
+
+    std::filesystem::remove(path);
+}
+
+}  // namespace obt
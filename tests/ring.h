@@ -0,0 +1,106 @@
+#pragma once
+
+#include <thread>
+
+namespace obt {
+
+TEST(SpscRingTest, TestFullAndEmpty) {
+    ob::SpscRing<int> ring(3);
+    ASSERT_EQ(ring.capacity(), 4) << "Rounded up to a power of two";
+    ASSERT_TRUE(ring.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_push(i));
+    }
+    ASSERT_FALSE(ring.try_push(4)) << "The ring is full";
+
+    int item = -1;
+    ASSERT_TRUE(ring.try_pop(item));
+    ASSERT_EQ(item, 0);
+    ASSERT_TRUE(ring.try_push(4)) << "Room was made";
+
+    // Items come out in order, across the end of the slots
+    int batch[8] = {};
+    ASSERT_EQ(ring.pop_batch(batch, 8), 4);
+    ASSERT_EQ((std::vector<int>(batch, batch + 4)),
+              (std::vector<int>{1, 2, 3, 4}));
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.pop_batch(batch, 8), 0);
+}
+
+TEST(SpscRingTest, TestTwoThreads) {
+    ob::SpscRing<int> ring(64);
+    constexpr int count = 100000;
+
+    std::thread producer([&ring] {
+        ob::BackOff wait;
+        for (int i = 0; i < count; ++i) {
+            ring.push(i, wait);
+        }
+    });
+
+    std::vector<int> received;
+    int batch[16];
+    ob::BackOff wait;
+    while (received.size() < count) {
+        auto const popped = ring.pop_batch(batch, 16);
+        if (popped == 0) {
+            wait();
+            continue;
+        }
+        wait.reset();
+        received.insert(std::end(received), batch, batch + popped);
+    }
+    producer.join();
+
+    for (int i = 0; i < count; ++i) {
+        ASSERT_EQ(received[static_cast<std::size_t>(i)], i);
+    }
+}
+
+/**
+ * A pipeline must match like a book used directly, and report the same
+ * events in the same order.
+ */
+TEST(PipelineTest, TestSameAsBook) {
+    spdlog::set_level(spdlog::level::critical);
+
+    // Small rings, so that both threads have to wait
+    ob::PipelineConfig config;
+    config.order_capacity = 8;
+    config.event_capacity = 8;
+    config.batch_size = 4;
+    ob::Pipeline<ob::MapBackend, RecordingSink> pipeline(config);
+    ob::OrderBook<ob::MapBackend, RecordingSink> expected;
+
+    for (ob::OrderId id = 1; id <= 2000; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        ob::Order order{id, side, id % 9 + 1, 1000 + (id * 37) % 50};
+        if (id % 5 == 0) {
+            order.id = id - 3;
+            pipeline.submit(ob::OrderType::CANCEL, order);
+            expected.cancel(order);
+        } else {
+            pipeline.submit(ob::OrderType::NEW, order);
+            expected.place_order(order);
+        }
+    }
+    pipeline.stop();
+
+    ASSERT_EQ(table(pipeline.book().bids), table(expected.bids));
+    ASSERT_EQ(table(pipeline.book().asks), table(expected.asks));
+
+    auto const &output = pipeline.output();
+    ASSERT_EQ(output.trades.size(), expected.sink.trades.size());
+    for (std::size_t i = 0; i < output.trades.size(); ++i) {
+        ASSERT_EQ(output.trades[i].resting_id,
+                  expected.sink.trades[i].resting_id);
+        ASSERT_EQ(output.trades[i].quantity, expected.sink.trades[i].quantity);
+    }
+    ASSERT_EQ(output.added.size(), expected.sink.added.size());
+    ASSERT_EQ(output.cancelled.size(), expected.sink.cancelled.size());
+    ASSERT_EQ(output.reduced.size(), expected.sink.reduced.size());
+    ASSERT_EQ(pipeline.latency().count, 2000);
+}
+
+}  // namespace obt
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "prefix_sum.h"
+
+namespace obt {
+
+TEST(PrefixSumTest, TestScalar) {
+    std::vector<ob::Quantity> values{3, 0, 4, 1, 0, 0, 5, 2, 6};
+    auto const within = [&values](std::int64_t budget) {
+        return ob::detail::prefix_within_scalar(values.data(), values.size(),
+                                                budget);
+    };
+    ASSERT_EQ(within(-1), 0u);
+    ASSERT_EQ(within(2), 0u);
+    ASSERT_EQ(within(3), 2u) << "Zeros are part of the prefix";
+    ASSERT_EQ(within(7), 3u);
+    ASSERT_EQ(within(8), 6u);
+    ASSERT_EQ(within(20), 8u);
+    ASSERT_EQ(within(21), 9u);
+    ASSERT_EQ(within(1000), 9u);
+    ASSERT_EQ(ob::detail::prefix_within_scalar(values.data(), 0, 10), 0u);
+}
+
+/**
+ * Every kernel gives the same answer, whatever the length of the input and
+ * wherever the budget runs out, including past the range of a Quantity.
+ */
+TEST(PrefixSumTest, TestKernelsAgree) {
+    std::vector<ob::Quantity> values;
+    for (int i = 0; i < 67; ++i) {
+        values.push_back(i % 5 == 0 ? 0 : (i * 7919) % 100);
+    }
+    values.push_back(std::numeric_limits<ob::Quantity>::max());
+    values.push_back(std::numeric_limits<ob::Quantity>::max());
+    values.push_back(1);
+
+    std::vector<std::size_t (*)(ob::Quantity const *, std::size_t,
+                                std::int64_t)>
+        kernels{ob::detail::prefix_within};
+    if (ob::detail::has_avx2()) {
+        kernels.push_back(ob::detail::prefix_within_avx2);
+    }
+
+    std::int64_t total = 0;
+    for (auto value : values) {
+        total += value;
+    }
+    for (std::size_t count = 0; count <= values.size(); ++count) {
+        for (std::int64_t budget = -1; budget <= total + 1;
+             budget = budget < 5000 ? budget + 1 : budget * 2 + 1) {
+            auto const expected = ob::detail::prefix_within_scalar(
+                values.data(), count, budget);
+            for (auto kernel : kernels) {
+                ASSERT_EQ(kernel(values.data(), count, budget), expected)
+                    << "count=" << count << " budget=" << budget;
+            }
+        }
+        ASSERT_EQ(ob::detail::prefix_within(values.data(), count, total),
+                  count);
+    }
+}
+
+}  // namespace obt
@@ -4,6 +4,25 @@
 
 // Test files
 
+#include "allocation.h"
+#include "amend.h"
+#include "binary.h"
 #include "cancel.h"
+#include "depth.h"
+#include "event_tests.h"
 #include "execution.h"
-#include "new_order.h"
\ No newline at end of file
+#include "histogram.h"
+#include "ladder.h"
+#include "limit_tests.h"
+#include "liquidity.h"
+#include "manager.h"
+#include "new_order.h"
+#include "parser.h"
+#include "pool.h"
+#include "protocol.h"
+#include "recovery.h"
+#include "restore.h"
+#include "ring.h"
+#include "sweep.h"
+#include "time_in_force.h"
+#include "uncross.h"
\ No newline at end of file
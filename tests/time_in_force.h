@@ -0,0 +1,132 @@
+#pragma once
+
+#include <sstream>
+
+namespace obt {
+
+template <typename Book>
+void check_time_in_force(Book &order_book) {
+    ob::Order ask1{1, ob::OrderSide::SELL, 5, 110};
+    ob::Order ask2{2, ob::OrderSide::SELL, 5, 115};
+    order_book.ask(ask1);
+    order_book.ask(ask2);
+    auto const asks = table(order_book.asks);
+
+    // Not enough quantity up to 115: nothing happens
+    ob::Order fok{3, ob::OrderSide::BUY, 11, 115, ob::TimeInForce::FOK};
+    ASSERT_TRUE(order_book.bid(fok));
+    ASSERT_EQ(fok.quantity, 11);
+    ASSERT_EQ(table(order_book.asks), asks);
+    ASSERT_TRUE(order_book.bids.empty());
+
+    // The rest of an IOC order is dropped
+    ob::Order ioc{4, ob::OrderSide::BUY, 7, 110, ob::TimeInForce::IOC};
+    ASSERT_TRUE(order_book.bid(ioc));
+    ASSERT_EQ(ioc.quantity, 2);
+    ASSERT_EQ(table(order_book.asks), (Table{{115, {ask2}}}));
+    ASSERT_TRUE(order_book.bids.empty());
+
+    // A FOK order filled entirely, and a market order
+    ob::Order bid{5, ob::OrderSide::BUY, 10, 100};
+    order_book.bid(bid);
+    ob::Order filled{6, ob::OrderSide::BUY, 5, 115, ob::TimeInForce::FOK};
+    ASSERT_TRUE(order_book.bid(filled));
+    ASSERT_EQ(filled.quantity, 0);
+    ASSERT_TRUE(order_book.asks.empty());
+
+    ob::Order market{7, ob::OrderSide::SELL, 4,
+                     ob::market_price(ob::OrderSide::SELL),
+                     ob::TimeInForce::IOC};
+    ASSERT_TRUE(order_book.ask(market));
+    ASSERT_EQ(market.quantity, 0);
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::BUY, 100), 6);
+
+    // Market orders cannot rest
+    market.id = 8;
+    market.time_in_force = ob::TimeInForce::GTC;
+    ASSERT_FALSE(order_book.ask(market));
+    ASSERT_EQ(order_book.quantity_at(ob::OrderSide::BUY, 100), 6);
+}
+
+TEST_F(OrderBookTest, TestTimeInForce) {
+    check_time_in_force(this->order_book);
+}
+
+TEST_F(FlatOrderBookTest, TestTimeInForce) {
+    check_time_in_force(this->order_book);
+
+    // The limit of an IOC order may be outside of the book
+    ob::Order ioc{9, ob::OrderSide::SELL, 10, 1, ob::TimeInForce::IOC};
+    ASSERT_TRUE(order_book.ask(ioc));
+    ASSERT_EQ(ioc.quantity, 4);
+    ASSERT_TRUE(order_book.bids.empty());
+}
+
+TEST_F(EventsTest, TestKilledOrderHasNoEvents) {
+    ob::Order ask{1, ob::OrderSide::SELL, 5, 110};
+    order_book.ask(ask);
+    auto const sequence = order_book.sequence();
+
+    ob::Order fok{2, ob::OrderSide::BUY, 6, 120, ob::TimeInForce::FOK};
+    order_book.bid(fok);
+    ASSERT_TRUE(order_book.sink.trades.empty());
+    ASSERT_EQ(order_book.sink.added.size(), 1u);
+    ASSERT_EQ(order_book.sequence(), sequence);
+}
+
+template <typename Book>
+void check_covers(Book &order_book) {
+    // Asks at 205, 210, 215 and bids at 195, 190, 185, 10 each
+    for (ob::OrderId id = 1; id <= 3; ++id) {
+        ob::Order ask{id, ob::OrderSide::SELL, 10, 200 + 5 * id};
+        ob::Order bid{id + 3, ob::OrderSide::BUY, 10, 200 - 5 * id};
+        order_book.ask(ask);
+        order_book.bid(bid);
+    }
+
+    ASSERT_TRUE(order_book.asks.covers(210, 20));
+    ASSERT_FALSE(order_book.asks.covers(210, 21));
+    ASSERT_FALSE(order_book.asks.covers(200, 1)) << "No ask at or below 200";
+    ASSERT_TRUE(order_book.bids.covers(185, 30));
+    ASSERT_FALSE(order_book.bids.covers(190, 21));
+}
+
+TEST_F(OrderBookTest, TestCovers) { check_covers(this->order_book); }
+
+TEST_F(FlatOrderBookTest, TestCovers) { check_covers(this->order_book); }
+
+TEST(TimeInForceTest, TestFormats) {
+    ob::OrderReader reader(
+        "A,1,B,5,100,IOC\nA,X,2,S,5,MKT,FOK\nA,3,B,1,2,3,GTC\n");
+    ob::ParsedLine line;
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_TRUE(line.symbol.empty());
+    ASSERT_EQ(line.order,
+              (ob::Order{1, ob::OrderSide::BUY, 5, 100, ob::TimeInForce::IOC}));
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_EQ(line.error, nullptr);
+    ASSERT_EQ(line.symbol, "X");
+    ASSERT_EQ(line.order, (ob::Order{2, ob::OrderSide::SELL, 5,
+                                     ob::market_price(ob::OrderSide::SELL),
+                                     ob::TimeInForce::FOK}));
+    ASSERT_TRUE(reader.next(line));
+    ASSERT_NE(line.error, nullptr) << "Too many fields";
+
+    // The time in force uses a reserved byte of binary records
+    ob::Order const order{1, ob::OrderSide::SELL, 5, 110,
+                          ob::TimeInForce::FOK};
+    std::ostringstream stream;
+    ob::binary::Writer writer(stream, false);
+    writer.write(ob::OrderType::NEW, order);
+    auto data = stream.str();
+    ob::binary::Reader reader_binary(data);
+    ob::binary::Record record;
+    ASSERT_TRUE(reader_binary.read(0, record));
+    ASSERT_EQ(record.order, order);
+
+    data[ob::binary::header_size + 2] = 3;
+    ASSERT_FALSE(ob::binary::Reader(data).read(0, record));
+}
+
+}  // namespace obt
@@ -0,0 +1,114 @@
+#pragma once
+
+namespace obt {
+
+TEST(AuctionTest, TestEquilibrium) {
+    // Most volume at 100: 30 bid, 25 offered
+    auto result = ob::detail::equilibrium(
+        Depth{{105, 10, 1}, {100, 20, 1}}, Depth{{95, 15, 1}, {100, 10, 1}});
+    ASSERT_EQ(result.price, 100);
+    ASSERT_EQ(result.volume, 25);
+    ASSERT_EQ(result.surplus, 5);
+
+    // Same volume and surplus everywhere: buyers left push the price up,
+    // sellers left push it down
+    result = ob::detail::equilibrium(Depth{{102, 20, 1}},
+                                     Depth{{98, 10, 1}});
+    ASSERT_EQ(result.price, 102);
+    ASSERT_EQ(result.volume, 10);
+    result = ob::detail::equilibrium(Depth{{102, 10, 1}},
+                                     Depth{{98, 20, 1}});
+    ASSERT_EQ(result.price, 98);
+    ASSERT_EQ(result.surplus, -10);
+
+    // Balanced: the middle candidate, here the higher of two
+    result = ob::detail::equilibrium(Depth{{104, 10, 1}},
+                                     Depth{{100, 5, 1}, {102, 5, 1}});
+    ASSERT_EQ(result.price, 104);
+    ASSERT_EQ(result.surplus, 0);
+
+    result = ob::detail::equilibrium(Depth{}, Depth{{98, 20, 1}});
+    ASSERT_EQ(result.volume, 0);
+}
+
+TEST_F(EventsTest, TestUncross) {
+    order_book.open_auction();
+    ASSERT_TRUE(order_book.in_auction());
+
+    std::vector<ob::Order> orders{
+        {1, ob::OrderSide::BUY, 10, 105}, {2, ob::OrderSide::BUY, 20, 100},
+        {3, ob::OrderSide::SELL, 15, 95}, {4, ob::OrderSide::SELL, 10, 100},
+        {5, ob::OrderSide::BUY, 5, 90},   {6, ob::OrderSide::SELL, 5, 110}};
+    ASSERT_EQ(order_book.submit_batch(orders.data(), orders.size()), 6u);
+    ASSERT_TRUE(order_book.sink.trades.empty()) << "Nothing matched yet";
+    ASSERT_EQ(order_book.bids.best_price(), 105);
+    ASSERT_EQ(order_book.asks.best_price(), 95);
+
+    ob::Order ioc{7, ob::OrderSide::BUY, 5, 110, ob::TimeInForce::IOC};
+    ASSERT_FALSE(order_book.place_order(ioc));
+    order_book.sink.level_updates.clear();
+
+    auto const result = order_book.uncross();
+    ASSERT_FALSE(order_book.in_auction());
+    ASSERT_EQ(result.price, 100);
+    ASSERT_EQ(result.volume, 25);
+
+    ob::Quantity traded = 0;
+    for (auto const &trade : order_book.sink.trades) {
+        ASSERT_EQ(trade.price, 100);
+        traded += trade.quantity;
+    }
+    ASSERT_EQ(traded, 25);
+
+    // What is left does not cross any more
+    ASSERT_EQ(table(order_book.bids),
+              (Table{{100, {{2, ob::OrderSide::BUY, 5, 100}}},
+                     {90, {{5, ob::OrderSide::BUY, 5, 90}}}}));
+    ASSERT_EQ(table(order_book.asks),
+              (Table{{110, {{6, ob::OrderSide::SELL, 5, 110}}}}));
+
+    // One batch, each level once
+    ASSERT_EQ(order_book.sink.level_updates.size(), 1u);
+    auto const &updates = order_book.sink.level_updates[0];
+    ASSERT_EQ(updates.size(), 4u);
+    for (std::size_t i = 0; i < updates.size(); ++i) {
+        for (std::size_t j = i + 1; j < updates.size(); ++j) {
+            ASSERT_FALSE(updates[i].side == updates[j].side &&
+                         updates[i].price == updates[j].price);
+        }
+    }
+
+    // Back to continuous matching
+    ob::Order ask{8, ob::OrderSide::SELL, 5, 100};
+    order_book.ask(ask);
+    ASSERT_EQ(order_book.sink.trades.back().resting_id, 2);
+}
+
+template <typename Book>
+void check_submit_batch(Book &order_book) {
+    Book reference{ob::LadderConfig{100, 5, 256}};
+    std::vector<ob::Order> orders;
+    for (ob::OrderId id = 1; id <= 200; ++id) {
+        auto const side = id % 2 ? ob::OrderSide::BUY : ob::OrderSide::SELL;
+        orders.push_back(
+            ob::Order{id, side, id % 7 + 1, 150 + 5 * (id * 37 % 11)});
+    }
+    // Duplicate ID of a resting order, rejected
+    orders.insert(std::begin(orders) + 1, orders.front());
+
+    auto batch = orders;
+    ASSERT_EQ(order_book.submit_batch(batch.data(), batch.size()), 200u);
+    for (auto order : orders) {
+        reference.place_order(order);
+    }
+    ASSERT_EQ(levels(order_book.bids), levels(reference.bids));
+    ASSERT_EQ(levels(order_book.asks), levels(reference.asks));
+}
+
+TEST_F(OrderBookTest, TestSubmitBatch) { check_submit_batch(order_book); }
+
+TEST_F(FlatOrderBookTest, TestSubmitBatch) {
+    check_submit_batch(order_book);
+}
+
+}  // namespace obt